@@ -0,0 +1,182 @@
+
+#include "../format"
+#include "../string_builder"
+
+namespace SSTL_NAMESPACE {
+
+sstl_size_type format_arg::_measure() const
+{
+    switch (_kind)
+    {
+    case _bool_kind:
+        _size = _value.b ? 4 : 5;
+        break;
+    case _signed_kind:
+        _size = _value.i < 0 ? _decimal_digits(0 - static_cast<sstl_uint64>(_value.i)) + 1 : _decimal_digits(static_cast<sstl_uint64>(_value.i));
+        break;
+    case _unsigned_kind:
+        _size = _decimal_digits(_value.u);
+        break;
+    case _double_kind:
+        _size = sstl_from_size_cast(_write_double(_text, _value.d) - _text);
+        break;
+    case _float_kind:
+        _size = sstl_from_size_cast(_write_float(_text, _value.f) - _text);
+        break;
+    case _char_kind:
+    case _chars_kind:
+        break;
+    }
+    return _size;
+}
+
+char* format_arg::_write(char* p) const
+{
+    switch (_kind)
+    {
+    case _char_kind:
+        *p = _value.c;
+        break;
+    case _bool_kind:
+        memcpy(p, _value.b ? "true" : "false", _size);
+        break;
+    case _signed_kind:
+        if (_value.i < 0)
+        {
+            *p = '-';
+            _write_decimal_backward(p + _size, 0 - static_cast<sstl_uint64>(_value.i));
+        }
+        else
+            _write_decimal_backward(p + _size, static_cast<sstl_uint64>(_value.i));
+        break;
+    case _unsigned_kind:
+        _write_decimal_backward(p + _size, _value.u);
+        break;
+    case _double_kind:
+    case _float_kind:
+        memcpy(p, _text, _size);
+        break;
+    case _chars_kind:
+        if (_size != 0)
+            memcpy(p, _value.s, _size);
+        break;
+    }
+    return p + _size;
+}
+
+// Walk the format string once, calling op.text(first, count) for literal characters
+// and op.arg(arg) for the arguments, both passes share it so they cannot disagree
+//
+template
+    <class Op>
+static void _format_walk(string_view fmt, const format_arg* args, sstl_size_type count, Op& op)
+{
+    const char* p = fmt.data();
+    const char* const end = p + fmt.size();
+    sstl_size_type next = 0;
+    while (p != end)
+    {
+        const char* brace = p;
+        while (brace != end && *brace != '{' && *brace != '}')
+            ++brace;
+        if (brace != p)
+            op.text(p, sstl_from_size_cast(brace - p));
+        if (brace == end)
+            break;
+        p = brace + 1;
+        if (p != end && *p == *brace) // {{ or }}
+        {
+            op.text(brace, 1);
+            ++p;
+            continue;
+        }
+        if (*brace == '}') // lone closing brace, kept as is
+        {
+            op.text(brace, 1);
+            continue;
+        }
+        sstl_size_type index = 0;
+        const char* q = p;
+        while (q != end && *q >= '0' && *q <= '9')
+            index = index * 10 + static_cast<sstl_size_type>(*q++ - '0');
+        if (q == end || *q != '}') // not a placeholder, the brace is kept as is
+        {
+            op.text(brace, 1);
+            continue;
+        }
+        if (q == p) // {}
+            index = next++;
+        p = q + 1;
+        SSTL_ASSERT(index < count);
+        if (index < count)
+            op.arg(args[index]);
+    }
+}
+
+struct _format_measure_op
+{
+    sstl_size_type size;
+
+    void text(const char*, sstl_size_type n) {size += n;}
+    void arg(const format_arg& a)            {size += a._measure();}
+};
+
+struct _format_write_op
+{
+    char* p;
+
+    void text(const char* s, sstl_size_type n) {memcpy(p, s, n); p += n;}
+    void arg(const format_arg& a)              {p = a._write(p);}
+};
+
+sstl_size_type _format_size(string_view fmt, const format_arg* args, sstl_size_type count)
+{
+    _format_measure_op op = {0};
+    _format_walk(fmt, args, count, op);
+    return op.size;
+}
+
+char* _format_write(char* p, string_view fmt, const format_arg* args, sstl_size_type count)
+{
+    _format_write_op op = {p};
+    _format_walk(fmt, args, count, op);
+    return op.p;
+}
+
+string _format(string_view fmt, const format_arg* args, sstl_size_type count)
+{
+    const sstl_size_type size = _format_size(fmt, args, count);
+    if (size == 0)
+        return string();
+    string_builder builder(size); // the only chunk becomes the string
+    char* p = builder.append_uninitialized(size);
+    char* end = _format_write(p, fmt, args, count);
+    SSTL_ASSERT(end == p + size);
+    SSTL_USE(end);
+    return builder.freeze();
+}
+
+string& _format_to(string& s, string_view fmt, const format_arg* args, sstl_size_type count)
+{
+    const sstl_size_type size = _format_size(fmt, args, count);
+    if (size != 0)
+    {
+        // The format or an argument within s, like s itself, must survive the reallocation of s: a second
+        // reference makes the buffer shared, so appending copies it and the old buffer stays alive until we finish
+        const char* const first = s.data();
+        const char* const last = first + s.size();
+        bool aliased = fmt.data() < last && fmt.data() + fmt.size() > first;
+        for (sstl_size_type i = 0; i < count && !aliased; ++i)
+            aliased = args[i]._refers_to(first, last);
+        string keep;
+        if (aliased)
+            keep = s;
+        char* p = s.append_uninitialized(size);
+        char* end = _format_write(p, fmt, args, count);
+        SSTL_ASSERT(end == p + size);
+        SSTL_USE(end);
+    }
+    return s;
+}
+
+} // namespace
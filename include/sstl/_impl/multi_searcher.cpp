@@ -0,0 +1,201 @@
+#include "../multi_searcher"
+
+namespace SSTL_NAMESPACE {
+
+const unsigned multi_searcher::_output_flag;
+
+multi_searcher::multi_searcher()
+    :
+      _stride(0),
+      _transitions(NULL),
+      _state_count(0),
+      _outputs(NULL),
+      _output_begins(NULL),
+      _output_links(NULL),
+      _pattern_sizes(NULL),
+      _pattern_count(0)
+{
+    memset(_classes, 0, sizeof(_classes));
+}
+
+multi_searcher::multi_searcher(const string* patterns, size_type count)
+    :
+      _stride(0),
+      _transitions(NULL),
+      _state_count(0),
+      _outputs(NULL),
+      _output_begins(NULL),
+      _output_links(NULL),
+      _pattern_sizes(NULL),
+      _pattern_count(0)
+{
+    compile(patterns, count);
+}
+
+multi_searcher::~multi_searcher()
+{
+    _clear();
+}
+
+void multi_searcher::_clear()
+{
+    delete [] _transitions;
+    delete [] _outputs;
+    delete [] _output_begins;
+    delete [] _output_links;
+    delete [] _pattern_sizes;
+    _transitions = NULL;
+    _outputs = NULL;
+    _output_begins = NULL;
+    _output_links = NULL;
+    _pattern_sizes = NULL;
+    _stride = 0;
+    _state_count = 0;
+    _pattern_count = 0;
+    memset(_classes, 0, sizeof(_classes));
+}
+
+void multi_searcher::compile(const string* patterns, size_type count)
+{
+    _clear();
+
+    // Byte classes: the bytes that do not occur in the patterns share class zero
+    bool used [ 256 ];
+    memset(used, 0, sizeof(used));
+    size_type total = 0;
+    for (size_type p = 0; p < count; ++p)
+    {
+        const char* d = patterns[p].data();
+        for (size_type i = 0; i < patterns[p].size(); ++i)
+            used[static_cast<unsigned char>(d[i])] = true;
+        total += patterns[p].size();
+    }
+    unsigned distinct = 0;
+    for (unsigned b = 0; b < 256; ++b)
+        if (used[b])
+            ++distinct;
+    unsigned next_class = distinct < 256 ? 1 : 0;
+    for (unsigned b = 0; b < 256; ++b)
+        _classes[b] = static_cast<unsigned char>(used[b] ? next_class++ : 0);
+    _stride = next_class;
+
+    // Trie of the patterns, zero is no transition as the root is never a child
+    const size_type max_states = total + 1;
+    SSTL_ASSERT(static_cast<sstl_uint64>(max_states) * _stride < _output_flag); // too many patterns
+    unsigned* next = new unsigned[max_states * _stride];
+    memset(next, 0, max_states * _stride * sizeof(*next));
+    unsigned* pattern_states = new unsigned[count + 1];
+    _pattern_sizes = new size_type[count + 1];
+    _pattern_count = count;
+    unsigned states = 1;
+    for (size_type p = 0; p < count; ++p)
+    {
+        const char* d = patterns[p].data();
+        unsigned s = 0;
+        for (size_type i = 0; i < patterns[p].size(); ++i)
+        {
+            unsigned& t = next[s * _stride + _classes[static_cast<unsigned char>(d[i])]];
+            if (t == 0)
+                t = states++;
+            s = t;
+        }
+        pattern_states[p] = s; // the root for the empty pattern, which never matches
+        _pattern_sizes[p] = patterns[p].size();
+    }
+    _state_count = states;
+
+    // Patterns ending exactly at each state, in the order of patterns
+    _output_begins = new size_type[states + 1];
+    memset(_output_begins, 0, (states + 1) * sizeof(*_output_begins));
+    for (size_type p = 0; p < count; ++p)
+        if (pattern_states[p] != 0)
+            ++_output_begins[pattern_states[p] + 1];
+    for (unsigned s = 0; s < states; ++s)
+        _output_begins[s + 1] += _output_begins[s];
+    _outputs = new size_type[_output_begins[states] + 1];
+    size_type* fill = new size_type[states];
+    memcpy(fill, _output_begins, states * sizeof(*fill));
+    for (size_type p = 0; p < count; ++p)
+        if (pattern_states[p] != 0)
+            _outputs[fill[pattern_states[p]]++] = p;
+    delete [] fill;
+    delete [] pattern_states;
+
+    // Breadth first pass computes failure links, completes missing transitions
+    // through the failure states, and links every state to the nearest failure state with outputs
+    unsigned* failures = new unsigned[states];
+    unsigned* queue = new unsigned[states];
+    _output_links = new unsigned[states];
+    unsigned queue_begin = 0;
+    unsigned queue_end = 0;
+    failures[0] = 0;
+    _output_links[0] = 0;
+    for (unsigned c = 0; c < _stride; ++c)
+    {
+        const unsigned child = next[c];
+        if (child != 0)
+        {
+            failures[child] = 0;
+            _output_links[child] = 0;
+            queue[queue_end++] = child;
+        }
+    }
+    while (queue_begin != queue_end)
+    {
+        const unsigned s = queue[queue_begin++];
+        const unsigned* failure_row = next + failures[s] * _stride; // complete, as the failure state is shallower
+        unsigned* row = next + s * _stride;
+        for (unsigned c = 0; c < _stride; ++c)
+        {
+            const unsigned child = row[c];
+            if (child != 0)
+            {
+                const unsigned f = failure_row[c];
+                failures[child] = f;
+                _output_links[child] = _output_begins[f] != _output_begins[f + 1] ? f : _output_links[f];
+                queue[queue_end++] = child;
+            }
+            else
+                row[c] = failure_row[c];
+        }
+    }
+    delete [] queue;
+    delete [] failures;
+
+    // Final table holds row offsets of the targets, flagged when some pattern ends there
+    _transitions = next;
+    for (size_type i = 0; i < states * _stride; ++i)
+    {
+        const unsigned t = _transitions[i];
+        const bool output = _output_begins[t] != _output_begins[t + 1] || _output_links[t] != 0;
+        _transitions[i] = t * _stride | (output ? _output_flag : 0);
+    }
+}
+
+struct _multi_searcher_stop
+{
+    bool operator()(sstl_size_type, sstl_size_type) const {return false;}
+};
+
+struct _multi_searcher_counter
+{
+    sstl_size_type count;
+
+    _multi_searcher_counter() : count(0) {}
+    bool operator()(sstl_size_type, sstl_size_type) {++count; return true;}
+};
+
+bool multi_searcher::contains_any(const char* text, size_type size) const
+{
+    _multi_searcher_stop stop;
+    return !scan(text, size, stop);
+}
+
+multi_searcher::size_type multi_searcher::count(const string& text) const
+{
+    _multi_searcher_counter counter;
+    scan(text, counter);
+    return counter.count;
+}
+
+}
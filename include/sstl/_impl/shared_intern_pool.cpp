@@ -0,0 +1,378 @@
+#include "../shared_intern_pool"
+
+#if !defined(_WIN32)
+
+#include "../atomic"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace SSTL_NAMESPACE {
+
+// Layout of the segment:
+//   header
+//   table of cells, table_capacity items
+//   heap of string buffers, each aligned as the string buffer
+//
+// All positions in the segment are offsets from its beginning, as every process maps it at its own address.
+// Offset zero in a cell means an empty cell, and offset zero passed between processes means an empty string.
+
+static const unsigned _shared_intern_magic = 0x53494E50; // "SINP"
+static const unsigned _shared_intern_layout = (sizeof(string::_buffer_type) << 16) | (sizeof(void*) << 8) | 1;
+
+struct _shared_intern_cell
+{
+    unsigned hash;        // written before the offset is published
+    volatile int offset;  // of the buffer, zero for an empty cell
+};
+
+struct _shared_intern_header
+{
+    unsigned magic;
+    unsigned layout;
+    volatile int ready;     // published by the creator when the segment is initialized
+    unsigned table_capacity;
+    unsigned heap_begin;
+    unsigned heap_end;
+    volatile int heap_used; // offset of the first free byte in the heap, changed under the lock
+    volatile int count;     // changed under the lock
+    pthread_mutex_t lock;   // process-shared and robust
+
+    _shared_intern_cell* cells()
+    {
+        return reinterpret_cast<_shared_intern_cell*>(this + 1);
+    }
+    const _shared_intern_cell* cells() const
+    {
+        return reinterpret_cast<const _shared_intern_cell*>(this + 1);
+    }
+};
+
+static inline sstl_size_type _shared_intern_align(sstl_size_type n)
+{
+    return (n + sizeof(sstl_uint64) - 1) & ~static_cast<sstl_size_type>(sizeof(sstl_uint64) - 1);
+}
+
+const shared_intern_pool::size_type shared_intern_pool::npos;
+
+shared_intern_pool::shared_intern_pool()
+    :
+      _header(NULL),
+      _segment_size(0),
+      _table_capacity(0),
+      _heap_begin(0),
+      _heap_end(0)
+{}
+
+shared_intern_pool::~shared_intern_pool()
+{
+    close();
+}
+
+bool shared_intern_pool::create(const char* name, size_type table_capacity, size_type heap_size, mode_t mode)
+{
+    SSTL_ASSERT(!is_open());
+    SSTL_ASSERT(table_capacity != 0 && table_capacity <= 0x10000000u);
+
+    size_type capacity = 1;
+    while (capacity < table_capacity)
+        capacity <<= 1;
+    const sstl_uint64 segment_size = sizeof(_shared_intern_header)
+                                   + static_cast<sstl_uint64>(capacity) * sizeof(_shared_intern_cell)
+                                   + _shared_intern_align(heap_size);
+    if (segment_size > 0x7FFFFFFF) // offsets are kept in int
+        return false;
+
+    const int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, mode);
+    if (fd < 0)
+        return false;
+    if (ftruncate(fd, static_cast<off_t>(segment_size)) != 0 || !_map(fd, static_cast<size_type>(segment_size)))
+    {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+    ::close(fd);
+
+    // New segment is zero filled, so all cells are empty
+    _header->magic = _shared_intern_magic;
+    _header->layout = _shared_intern_layout;
+    _header->table_capacity = capacity;
+    _header->heap_begin = static_cast<unsigned>(_shared_intern_align(sizeof(_shared_intern_header) + capacity * sizeof(_shared_intern_cell)));
+    _header->heap_end = static_cast<unsigned>(segment_size);
+    _header->heap_used = static_cast<int>(_header->heap_begin);
+    _header->count = 0;
+
+    pthread_mutexattr_t attr;
+    int result = pthread_mutexattr_init(&attr);
+    SSTL_ASSERT(result == 0);
+    result = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    SSTL_ASSERT(result == 0);
+    result = pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+    SSTL_ASSERT(result == 0);
+    result = pthread_mutex_init(&_header->lock, &attr);
+    SSTL_ASSERT(result == 0);
+    result = pthread_mutexattr_destroy(&attr);
+    SSTL_ASSERT(result == 0);
+    SSTL_USE(result);
+
+    _attach();
+    atomic_int::static_store_release(&_header->ready, 1);
+    return true;
+}
+
+bool shared_intern_pool::open(const char* name)
+{
+    SSTL_ASSERT(!is_open());
+
+    const int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0)
+        return false;
+
+    // The creator might be still initializing the segment, give it some time
+    bool ok = false;
+    for (int attempt = 0; attempt < 1000 && !ok; ++attempt)
+    {
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            break;
+        if (static_cast<size_type>(st.st_size) < sizeof(_shared_intern_header))
+            sched_yield();
+        else
+        {
+            if (_header == NULL && !_map(fd, static_cast<size_type>(st.st_size)))
+                break;
+            if (atomic_int::static_load_acquire(&_header->ready) != 0)
+                ok = true;
+            else
+                sched_yield();
+        }
+    }
+    ::close(fd);
+
+    if (ok)
+        ok = _attach();
+    if (!ok)
+        close();
+    return ok;
+}
+
+bool shared_intern_pool::open_or_create(const char* name, size_type table_capacity, size_type heap_size, mode_t mode)
+{
+    for (int attempt = 0; attempt < 2; ++attempt) // the segment may disappear between the calls
+    {
+        if (open(name))
+            return true;
+        if (create(name, table_capacity, heap_size, mode))
+            return true;
+        if (errno != EEXIST)
+            return false;
+    }
+    return false;
+}
+
+void shared_intern_pool::close()
+{
+    if (_header != NULL)
+    {
+        munmap(_header, _segment_size);
+        _header = NULL;
+        _segment_size = 0;
+        _table_capacity = 0;
+        _heap_begin = 0;
+        _heap_end = 0;
+    }
+}
+
+bool shared_intern_pool::remove(const char* name)
+{
+    return shm_unlink(name) == 0;
+}
+
+bool shared_intern_pool::_map(int fd, size_type segment_size)
+{
+    void* p = mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+        return false;
+    _header = static_cast<_shared_intern_header*>(p);
+    _segment_size = segment_size;
+    return true;
+}
+
+// Check the header and keep the fields that all other offsets are checked against
+//
+bool shared_intern_pool::_attach()
+{
+    const sstl_uint64 table_capacity = _header->table_capacity;
+    const sstl_uint64 heap_begin = _header->heap_begin;
+    const sstl_uint64 heap_end = _header->heap_end;
+    if (_header->magic != _shared_intern_magic
+        || _header->layout != _shared_intern_layout
+        || table_capacity == 0 || (table_capacity & (table_capacity - 1)) != 0
+        || heap_begin != _shared_intern_align(static_cast<size_type>(sizeof(_shared_intern_header) + table_capacity * sizeof(_shared_intern_cell)))
+        || heap_begin > heap_end || heap_end > _segment_size)
+        return false;
+    _table_capacity = static_cast<size_type>(table_capacity);
+    _heap_begin = static_cast<size_type>(heap_begin);
+    _heap_end = static_cast<size_type>(heap_end);
+    return true;
+}
+
+// The string buffer at the offset, or NULL if there is none within the heap
+//
+const string::_buffer_type* shared_intern_pool::_buffer_at(sstl_uint64 offset) const
+{
+    if (offset < _heap_begin || offset >= _heap_end
+        || offset % sizeof(sstl_uint64) != 0
+        || _heap_end - offset < string::_buffer_type_header_sizeof + 1)
+        return NULL;
+    const string::_buffer_type* b = reinterpret_cast<const string::_buffer_type*>(reinterpret_cast<const char*>(_header) + offset);
+    const sstl_uint64 size = b->_size;
+    if (size + 1 > _heap_end - offset - string::_buffer_type_header_sizeof
+        || b->_ref_count < string::_immortal_ref_count / 2)
+        return NULL;
+    return b;
+}
+
+const string::_buffer_type* shared_intern_pool::_find(unsigned hash, const char* s, size_type size) const
+{
+    const _shared_intern_cell* cells = _header->cells();
+    const unsigned mask = static_cast<unsigned>(_table_capacity - 1);
+    unsigned index = hash & mask;
+    for (size_type probes = 0; probes < _table_capacity; ++probes)
+    {
+        const int offset = atomic_int::static_load_acquire(&cells[index].offset);
+        if (offset == 0)
+            return NULL;
+        if (cells[index].hash == hash)
+        {
+            // The size is checked against the heap again, another process may change it meanwhile
+            const string::_buffer_type* b = _buffer_at(static_cast<unsigned>(offset));
+            if (b != NULL && b->_size == size
+                && size + 1 <= _heap_end - static_cast<unsigned>(offset) - string::_buffer_type_header_sizeof
+                && memcmp(b->_bytes, s, size) == 0)
+                return b;
+        }
+        index = (index - 1) & mask; // the same probing as in the private pool
+    }
+    return NULL;
+}
+
+// False if the lock is not recoverable, an owner died and the next one did not make it consistent
+//
+bool shared_intern_pool::_lock()
+{
+    const int result = pthread_mutex_lock(&_header->lock);
+    if (result == EOWNERDEAD)
+    {
+        // The owner died while adding a string. A string is published with a single store
+        // after it is completely written, so the table is consistent, only the count may be behind.
+        const _shared_intern_cell* cells = _header->cells();
+        int count = 0;
+        for (size_type i = 0; i < _table_capacity; ++i)
+            if (cells[i].offset != 0)
+                ++count;
+        _header->count = count;
+        pthread_mutex_consistent(&_header->lock);
+    }
+    else if (result != 0)
+    {
+        SSTL_ASSERT(result == ENOTRECOVERABLE);
+        return false;
+    }
+    return true;
+}
+
+string shared_intern_pool::intern_create(const char* s, size_type size)
+{
+    SSTL_ASSERT(is_open());
+    if (size == 0)
+        return string();
+
+    const unsigned hash = string::static_hash(s, size);
+    const string::_buffer_type* found = _find(hash, s, size);
+    if (found == NULL)
+    {
+        if (!_lock())
+            return string::intern_create(s, size);
+        found = _find(hash, s, size); // could be added by another process meanwhile
+        if (found == NULL)
+        {
+            const size_type capacity = _shared_intern_align(size + 1 < string::_minimum_capacity ? string::_minimum_capacity : size + 1);
+            const size_type buffer_sizeof = string::_buffer_type_header_sizeof + capacity;
+            const size_type heap_used = static_cast<size_type>(_header->heap_used);
+            const int count = _header->count;
+            const bool full = count < 0 || static_cast<size_type>(count + 1) * 2 > _table_capacity
+                           || heap_used < _heap_begin || heap_used > _heap_end || heap_used % sizeof(sstl_uint64) != 0
+                           || buffer_sizeof > _heap_end - heap_used;
+            if (!full)
+            {
+                string::_buffer_type* b = reinterpret_cast<string::_buffer_type*>(reinterpret_cast<char*>(_header) + heap_used);
+                b->_hash = hash;         // string::hash() is free, the buffer never changes
+                b->_capacity = capacity; // not interned in terms of the private pool
+                b->_size = size;
+                b->_ref_count = string::_immortal_ref_count;
+                memcpy(b->_bytes, s, size);
+                b->_bytes[size] = '\0'; // c_str never has to reallocate
+                _header->heap_used = static_cast<int>(heap_used + buffer_sizeof);
+
+                _shared_intern_cell* cells = _header->cells();
+                const unsigned mask = static_cast<unsigned>(_table_capacity - 1);
+                unsigned index = hash & mask;
+                size_type probes = 0;
+                while (cells[index].offset != 0 && ++probes < _table_capacity)
+                    index = (index - 1) & mask;
+                if (cells[index].offset == 0) // there is always a free cell unless the count is wrong
+                {
+                    cells[index].hash = hash;
+                    atomic_int::static_store_release(&cells[index].offset, static_cast<int>(heap_used));
+                    ++_header->count;
+                    found = b;
+                }
+            }
+        }
+        pthread_mutex_unlock(&_header->lock);
+        if (found == NULL)
+            return string::intern_create(s, size);
+    }
+    found->_ref_increment();
+    return string(const_cast<string::_buffer_type*>(found));
+}
+
+shared_intern_pool::size_type shared_intern_pool::offset_of(const string& s) const
+{
+    if (s.empty())
+        return 0;
+    if (_header == NULL)
+        return npos;
+    const char* begin = reinterpret_cast<const char*>(_header) + _heap_begin;
+    const char* end = reinterpret_cast<const char*>(_header) + _heap_end;
+    if (s.data() < begin || s.data() >= end)
+        return npos;
+    return static_cast<size_type>(s.data() - string::_buffer_type_header_sizeof - reinterpret_cast<const char*>(_header));
+}
+
+string shared_intern_pool::from_offset(size_type offset) const
+{
+    if (offset == 0)
+        return string();
+    SSTL_ASSERT(is_open());
+    const string::_buffer_type* b = _header != NULL ? _buffer_at(offset) : NULL;
+    SSTL_ASSERT(b != NULL); // points to a buffer
+    if (b == NULL)
+        return string();
+    b->_ref_increment();
+    return string(const_cast<string::_buffer_type*>(b));
+}
+
+shared_intern_pool::size_type shared_intern_pool::size() const
+{
+    return _header == NULL ? 0 : static_cast<size_type>(atomic_int::static_load_acquire(&_header->count));
+}
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 #include "../string"
 #include "../algorithm"
 #include "../mutex"
+#include "../sstl_simd.h"
+#include "../string_view"
 
 namespace SSTL_NAMESPACE {
 
@@ -45,17 +47,13 @@ string& string::assign(size_type size, char c)
     }
     else
     {
+        _forget_hash();
         _get_buffer()->_size = size;
         memset(_bytes, c, size);
     }
     return *this;
 }
 
-string& string::assign(const char* str)
-{
-    return assign(str, static_cast<size_type>(strlen(str)));
-}
-
 string& string::assign(const char* str, size_type size)
 {
     if (size == 0)
@@ -67,8 +65,9 @@ string& string::assign(const char* str, size_type size)
     }
     else
     {
+        _forget_hash();
         _get_buffer()->_size = size;
-        memcpy(_bytes, str, size);
+        memmove(_bytes, str, size); // str can be a view of this string
     }
     return *this;
 }
@@ -109,16 +108,15 @@ string& string::append(size_type size, char c)
     return *this;
 }
 
-string& string::append(const char* str)
-{
-    const size_type len = static_cast<size_type>(strlen(str));
-    return append(str, len);
-}
-
 string& string::append(const char* str, size_type size)
 {
     if (size != 0)
     {
+        // Characters of this string, like those of a view of it, must survive the reallocation:
+        // a second reference makes the buffer shared, so it is copied and the old one stays alive
+        string keep;
+        if (_is_in_buffer(str))
+            keep = *this;
         char* place = _append_uninitialized(size);
         memcpy(place, str, size);
     }
@@ -180,15 +178,12 @@ string& string::insert(size_type pos, size_type count, char c)
     return *this;
 }
 
-string& string::insert(size_type pos, const char* s)
-{
-    size_type size = static_cast<size_type>(strlen(s));
-    return insert(pos, s, size);
-}
-
 string& string::insert(size_type pos, const char* s, size_type count)
 {
     SSTL_ASSERT(pos <= size());
+    string keep; // the characters of this string stay where they are, see append
+    if (count != 0 && _is_in_buffer(s))
+        keep = *this;
     char* buff = _insert_uninitialized(pos, count);
     memcpy(buff, s, count);
     return *this;
@@ -217,9 +212,7 @@ string::iterator string::insert(const_iterator where, const_iterator input_first
 
 string& string::replace(size_type pos, size_type count, const string& str)
 {
-    char* buff = _replace_uninitialized(pos, count, str.size());
-    memcpy(buff, str.data(), str.size());
-    return *this;
+    return replace(pos, count, str.data(), str.size());
 }
 
 string& string::replace(const_iterator first, const_iterator last, const string& str)
@@ -240,6 +233,11 @@ string& string::replace(size_type pos, size_type count, const string& str, size_
 
 string& string::replace(size_type pos, size_type count, const char* s, size_type sCount)
 {
+    // Characters of this string are freed by a new buffer or moved by the shift in place,
+    // with a second reference the buffer is shared and the replacement is made in a copy
+    string keep;
+    if (sCount != 0 && _is_in_buffer(s))
+        keep = *this;
     char* buff = _replace_uninitialized(pos, count, sCount);
     memcpy(buff, s, sCount);
     return *this;
@@ -255,22 +253,6 @@ string& string::replace(const_iterator first, const_iterator last, const char* s
     return replace(pos, count, s, strCount);
 }
 
-string& string::replace(size_type pos, size_type count, const char* s)
-{
-    size_type sCount = static_cast<size_type>(strlen(s));
-    return replace(pos, count, s, sCount);
-}
-
-string& string::replace(const_iterator first, const_iterator last, const char* s)
-{
-    SSTL_ASSERT(first >= _bytes);
-    SSTL_ASSERT(last <= _bytes + size());
-    SSTL_ASSERT(first <= last);
-    size_type pos = static_cast<size_type>(first - _bytes);
-    size_type count = static_cast<size_type>(last - first);
-    return replace(pos, count, s);
-}
-
 string& string::replace(size_type pos, size_type count, size_type c_count, char c)
 {
     char* buff = _replace_uninitialized(pos, count, c_count);
@@ -326,15 +308,18 @@ const char* string::c_str() const
 // Return the hash value for a zero terminated character string.
 //
 // The algorithm is loosely based on Jenkins one-at-a-time hash function.
+// The case insensitive variant hashes the bytes converted to lower case.
 //
-unsigned string::static_hash(const char* p, size_type size)
+template
+    <bool Icase>
+static inline unsigned _static_hash(const char* p, sstl_size_type size)
 {
     if (size == 0)
         return 1;
 
     unsigned hash = size;
 
-#define HASH_BYTE   hash += static_cast<unsigned>(static_cast<unsigned char>(*p++)); \
+#define HASH_BYTE   hash += static_cast<unsigned>(Icase ? _ascii_to_lower(static_cast<unsigned char>(*p++)) : static_cast<unsigned char>(*p++)); \
                     hash += hash << 10; \
                     hash ^= hash >> 6;
 
@@ -367,19 +352,32 @@ unsigned string::static_hash(const char* p, size_type size)
     return hash;
 }
 
+unsigned string::static_hash(const char* p, size_type size)
+{
+    return _static_hash<false>(p, size);
+}
+
+unsigned string::static_hash_icase(const char* p, size_type size)
+{
+    return _static_hash<true>(p, size);
+}
+
+unsigned string::_memoize_hash() const
+{
+    const unsigned hash = static_hash(_bytes, size());
+    if (!is_shared()) // only this string refers to the buffer, no other thread can see it
+        const_cast<_buffer_type*>(_get_buffer())->_hash = hash;
+    return hash;
+}
+
 void string::resize(size_type new_size)
 {
-    size_type old_size = size();
+    const size_type old_size = size();
     if (new_size != old_size)
     {
-        if (is_shared() || new_size > old_size)
-        {
-            const size_type diff = new_size - old_size;
-            char* buff = _append_uninitialized(diff);
-            memset(buff, 0, diff);
-        }
-        else      // shrink self without a hassle
-            _get_buffer()->_size = new_size;
+        char* buff = _resize_uninitialized(new_size);
+        if (new_size > old_size)
+            memset(buff + old_size, 0, new_size - old_size);
     }
 }
 
@@ -405,6 +403,7 @@ string& string::erase(size_type pos, size_type count)
         }
         else
         {
+            _forget_hash();
             memmove(_bytes + pos, _bytes + end_pos, old_size - end_pos);
             _get_buffer()->_size -= count;
         }
@@ -414,6 +413,8 @@ string& string::erase(size_type pos, size_type count)
 
 string string::substr(size_type pos, size_type count) const
 {
+    if (pos == 0 && count >= size())
+        return *this; // shares the buffer
     string result;
     result.assign(*this, pos, count);  // this will take care of all caveats
     return result;
@@ -439,7 +440,10 @@ void string::clear()
             _clear_uninitizlized();
         }
         else
+        {
+            _forget_hash();
             _get_buffer()->_size = 0;
+        }
     }
 }
 
@@ -447,13 +451,7 @@ int string::compare(const string& s) const
 {
     if (_bytes == s._bytes) // fast version
         return 0;
-    return compare(s._bytes, size());
-}
-
-int string::compare(const char* s) const
-{
-    size_type len = static_cast<size_type>(strlen(s));
-    return compare(s, len);
+    return compare(s._bytes, s.size());
 }
 
 int string::compare(const char* s, size_type len) const
@@ -478,6 +476,46 @@ int string::compare(const char* s, size_type len) const
     return result;
 }
 
+int string::compare_icase(const char* s, size_type len) const
+{
+    const size_type size1 = size();
+    const int result = _simd_compare_icase(_bytes, s, size1 < len ? size1 : len);
+    if (result != 0 || size1 == len)
+        return result;
+    return size1 < len ? -1 : 1;
+}
+
+string& string::to_lower()
+{
+    _convert_case(false);
+    return *this;
+}
+
+string& string::to_upper()
+{
+    _convert_case(true);
+    return *this;
+}
+
+void string::_convert_case(bool upper)
+{
+    const size_type len = size();
+    if (len == 0)
+        return;
+    if (is_shared()) // convert while copying
+    {
+        char* bytes = _new_uninitialized(len);
+        _simd_ascii_case(bytes, _bytes, len, upper);
+        _get_buffer()->_ref_decrement();
+        _bytes = bytes;
+    }
+    else
+    {
+        _forget_hash();
+        _simd_ascii_case(_bytes, _bytes, len, upper);
+    }
+}
+
 bool string::operator==(const string& s) const
 {
     if (_bytes == s._bytes)
@@ -486,100 +524,53 @@ bool string::operator==(const string& s) const
     const _buffer_type* b2 = s._get_buffer();
     if ( b1->_size != b2->_size )
         return false;
+    if (((b1->_capacity & b2->_capacity) & _interned_flag) != 0) // the pool never holds two buffers with the same contents
+        return false;
+    if (b1->_hash != 0 && b2->_hash != 0 && b1->_hash != b2->_hash) // both known
+        return false;
     return memcmp(_bytes, s._bytes, b1->_size) == 0;
 }
 
-bool string::operator==(const char* s) const
-{
-    size_type len = static_cast<size_type>(strlen(s));
-    if (len != size())
-        return false;
-    return memcmp(_bytes, s, len) == 0;
-}
+// Searches are shared with string_view, see sstl/_impl/string_view.cpp
 
-string string::operator+(char c) const
+string::size_type string::find(char ch, size_type pos) const
 {
-    return _op_plus_right(&c, 1);
+    return string_view(*this).find(ch, pos);
 }
 
-string string::operator+(const char* s) const
+string::size_type string::find(const char* s, size_type pos, size_type count) const
 {
-    return _op_plus_right(s, static_cast<size_type>(strlen(s)));
+    return string_view(*this).find(s, pos, count);
 }
 
-string string::operator+(const string& s) const
+string::size_type string::rfind(char ch, size_type pos) const
 {
-    return _op_plus_right(s.data(), s.size());
+    return string_view(*this).rfind(ch, pos);
 }
 
-string operator+(char c, const string& s2)
+string::size_type string::rfind(const char* s, size_type pos, size_type count) const
 {
-    return s2._op_plus_left(&c, 1);
+    return string_view(*this).rfind(s, pos, count);
 }
 
-string operator+(const char* s1, const string& s2)
+string::size_type string::find_first_of(const char* s, size_type pos, size_type count) const
 {
-    return s2._op_plus_left(s1, static_cast<string::size_type>(strlen(s1)));
+    return string_view(*this).find_first_of(s, pos, count);
 }
 
-string::size_type string::find(char ch, size_type pos) const
+string::size_type string::find_last_of(const char* s, size_type pos, size_type count) const
 {
-   const_iterator i = cbegin() + pos;
-   const_iterator i_end = cend();
-   for ( ; i < i_end; ++i) // when pos >= size() return npos, as specified
-      if (*i == ch)
-         return static_cast<size_type>(i - cbegin());
-   return npos;
+    return string_view(*this).find_last_of(s, pos, count);
 }
 
-string::size_type string::find(const char* s, size_type pos, size_type count) const
+string::size_type string::find_first_not_of(const char* s, size_type pos, size_type count) const
 {
-    SSTL_ASSERT(s != NULL);
-    size_type len = size();
-    if (len - pos >= count && pos <= len)
-    {
-        if (count == 0) // this has to happen after the above if
-            return pos;
-        const char* d = data();
-        const char* d_end = data() + len;
-        const char* f = SSTL_NAMESPACE::search(d + pos, d_end, s, s + count);
-        if (f < d_end)
-            return static_cast<string::size_type>(f - d);
-    }
-    return npos;
+    return string_view(*this).find_first_not_of(s, pos, count);
 }
 
-string::size_type string::rfind(char ch, size_type pos) const
+string::size_type string::find_last_not_of(const char* s, size_type pos, size_type count) const
 {
-    size_type len = size();
-    if (len != 0)
-    {
-        const char* d = data();
-        const char* i = d + (pos < len ? pos : len - 1);
-        for (; i >= d; --i)
-            if (*i == ch)
-                return static_cast<string::size_type>(i - d);
-    }
-    return npos;
-}
-
-string::size_type string::rfind(const char* s, size_type pos, size_type count) const
-{
-    SSTL_ASSERT(s != NULL);
-    size_type len = size();
-    if (pos < len && len - pos >= count)
-        pos += count;
-    else
-        pos = len;
-    if (count == 0)
-        return pos;
-
-    const char* d = data();
-    const char* d_end = d + pos;
-    const char* f = SSTL_NAMESPACE::find_end(d, d_end, s, s + count);
-    if (f < d_end)
-        return static_cast<string::size_type>(f - d);
-    return npos;
+    return string_view(*this).find_last_not_of(s, pos, count);
 }
 
 void string::_reallocate(size_type new_capacity) const
@@ -599,12 +590,6 @@ void string::_clear_uninitizlized()
     _bytes = _empty_string_buffer._bytes;
 }
 
-void string::_set_uninitialized(const char* str)
-{
-    const size_type len = static_cast<size_type>(strlen(str));
-    _set_uninitialized(str, len);
-}
-
 void string::_set_uninitialized(const char* str, size_type size)
 {
     if (size == 0)
@@ -669,6 +654,7 @@ char* string::unshare()
         else
         {
             SSTL_ASSERT(!is_interned()); // attempt to modify a non-referenced interned string is made somehow
+            buff->_hash = 0; // the caller is going to change the contents
         }
     }
     return NULL;
@@ -689,10 +675,36 @@ char* string::_append_uninitialized(size_type count)
         _get_buffer()->_ref_decrement();
         _bytes = bytes;
     }
+    else
+        _forget_hash();
     _get_buffer()->_size = new_size;
     return _bytes + old_size;
 }
 
+// Resize, keeping the old characters up to the new size, and return the unshared bytes
+//
+char* string::_resize_uninitialized(size_type new_size)
+{
+    const size_type old_size = size();
+    if (new_size > old_size)
+        _append_uninitialized(new_size - old_size);
+    else if (new_size == 0)
+        clear();
+    else if (is_shared()) // copy only what is kept
+    {
+        char* bytes = _new_uninitialized(new_size);
+        memcpy(bytes, _bytes, new_size);
+        _get_buffer()->_ref_decrement();
+        _bytes = bytes;
+    }
+    else
+    {
+        _forget_hash();
+        _get_buffer()->_size = new_size;
+    }
+    return _bytes;
+}
+
 char* string::_insert_uninitialized(size_type index, size_type count)
 {
     SSTL_ASSERT(!is_interned()); // attempt to modify a readonly interned string is made
@@ -701,7 +713,10 @@ char* string::_insert_uninitialized(size_type index, size_type count)
     size_type old_size = size();
     size_type new_size = old_size + count;
     if (!is_shared() && new_size < capacity())
+    {
+        _forget_hash();
         memmove(_bytes + index + count, _bytes + index, old_size - index);
+    }
     else // grow    }
     {
         char* bytes = _new_uninitialized(new_size);
@@ -722,33 +737,113 @@ char* string::_replace_uninitialized(size_type pos, size_type count, size_type n
     SSTL_ASSERT(!is_interned()); // attempt to modify a readonly interned string is made
     SSTL_ASSERT(pos <= size());
     SSTL_ASSERT(pos + count <= size());
-    if (new_count < count) // shrink
-        erase(pos + new_count, count - new_count);
-    else if (new_count > count) // grow
-        _insert_uninitialized(pos + count, new_count - count);
+    const size_type old_size = size();
+    const size_type tail = old_size - pos - count;
+    const size_type new_size = old_size - count + new_count;
+    if (is_shared() || new_size > capacity())
+    {
+        // A single copy puts the kept bytes at their final positions
+        char* bytes = _new_uninitialized(new_size);
+        memcpy(bytes, _bytes, pos);
+        memcpy(bytes + pos + new_count, _bytes + pos + count, tail);
+        _get_buffer()->_ref_decrement();
+        _bytes = bytes;
+    }
+    else
+    {
+        _forget_hash();
+        if (new_count != count)
+            memmove(_bytes + pos + new_count, _bytes + pos + count, tail);
+        _get_buffer()->_size = new_size;
+    }
     return _bytes + pos;
 }
 
-string string::_op_plus_right(const char* s, size_type len) const
+string& string::apply_edits(const string_edit* edits, size_type count)
 {
-    string result;
-    result.reserve(size() + len);
-    result.append(*this);
-    result.append(s, len);
-    return result;
-}
+    const size_type old_size = size();
+    size_type new_size = old_size;
+    bool aliased = false;
+    for (size_type i = 0; i < count; ++i)
+    {
+        const string_edit& e = edits[i];
+        SSTL_ASSERT(e.pos <= old_size && e.count <= old_size - e.pos);
+        SSTL_ASSERT(i == 0 || edits[i - 1].pos + edits[i - 1].count <= e.pos); // sorted, not overlapping
+        new_size += e.text.size() - e.count;
+        if (e.text.data() >= _bytes && e.text.data() < _bytes + capacity())
+            aliased = true;
+    }
+    if (count == 0)
+        return *this;
+    SSTL_ASSERT(!is_interned()); // attempt to modify a readonly interned string is made
 
-string string::_op_plus_left(const char* s, size_type len) const
-{
-    string result;
-    result.reserve(size() + len);
-    result.append(s, len);
-    result.append(*this);
-    return result;
+    if (is_shared() || new_size > capacity() || aliased)
+    {
+        // Copy the kept parts and the new texts one after another into a new buffer
+        char* bytes = _new_uninitialized(new_size);
+        char* out = bytes;
+        size_type from = 0;
+        for (size_type i = 0; i < count; ++i)
+        {
+            const string_edit& e = edits[i];
+            memcpy(out, _bytes + from, e.pos - from);
+            out += e.pos - from;
+            memcpy(out, e.text.data(), e.text.size());
+            out += e.text.size();
+            from = e.pos + e.count;
+        }
+        memcpy(out, _bytes + from, old_size - from);
+        _get_buffer()->_ref_decrement();
+        _bytes = bytes;
+        return *this;
+    }
+
+    // In place every kept part moves once. The parts moving to the left go first, from the front,
+    // and the parts moving to the right go from the back, so no part overwrites one not moved yet.
+    // The texts go last into the gaps between the parts.
+    _forget_hash();
+    difference_type shift = 0;
+    size_type from = 0;
+    for (size_type i = 0; i <= count; ++i)
+    {
+        const size_type to = i < count ? edits[i].pos : old_size;
+        if (shift < 0 && to > from)
+            memmove(_bytes + from + shift, _bytes + from, to - from);
+        if (i < count)
+        {
+            shift += static_cast<difference_type>(edits[i].text.size() - edits[i].count);
+            from = edits[i].pos + edits[i].count;
+        }
+    }
+    size_type to = old_size;
+    for (size_type i = count + 1; i-- > 0; )
+    {
+        const size_type part_from = i > 0 ? edits[i - 1].pos + edits[i - 1].count : 0;
+        if (shift > 0 && to > part_from)
+            memmove(_bytes + part_from + shift, _bytes + part_from, to - part_from);
+        if (i > 0)
+        {
+            shift -= static_cast<difference_type>(edits[i - 1].text.size() - edits[i - 1].count);
+            to = edits[i - 1].pos;
+        }
+    }
+    for (size_type i = 0; i < count; ++i)
+    {
+        memcpy(_bytes + edits[i].pos + shift, edits[i].text.data(), edits[i].text.size());
+        shift += static_cast<difference_type>(edits[i].text.size() - edits[i].count);
+    }
+    _get_buffer()->_size = new_size;
+    return *this;
 }
 
 // Support for string interning
 
+#if SSTL_CONFIG_LOCK_PROFILING
+    typedef profiled_mutex _intern_mutex_type;
+#else
+    typedef mutex _intern_mutex_type;
+#endif
+
 class _intern_holder
 {
 public: // Constants:
@@ -768,11 +863,14 @@ public:
           _capacity(0),
           _count(0),
           _buffers(NULL)
+    #if SSTL_CONFIG_LOCK_PROFILING
+        , _lock("sstl::string intern pool")
+    #endif
     {}
 
     ~_intern_holder()
     {
-        lock_guard<mutex> lock(_lock);
+        lock_guard<_intern_mutex_type> lock(_lock);
         string::_buffer_type** it = _buffers;
         string::_buffer_type** itEnd = _buffers + _capacity;
         for ( ; it != itEnd; ++it )
@@ -793,22 +891,35 @@ public:
             }
             return; // empty string should not be interned into a hash table
         }
-        SSTL_ASSERT(buff->_hash == 0); // otherwise we would not be here
-        buff->_hash = string::static_hash(buff->_bytes, buff->_size);
+        if (buff->_ref_count >= string::_immortal_ref_count) // for example, in shared memory, cannot be changed
+        {
+            string::_buffer_type* interned = add(buff->_bytes, buff->_size);
+            buff->_ref_decrement();
+            str._bytes = interned->_bytes;
+            return;
+        }
+        SSTL_ASSERT((buff->_capacity & string::_interned_flag) == 0); // otherwise we would not be here
+        const unsigned hash = str.hash(); // possibly memoized
 
-        lock_guard<mutex> lock(_lock);
-        string::_buffer_type** cell = find_cell_for_addition(buff->_hash, buff->_bytes, buff->_size);
+        lock_guard<_intern_mutex_type> lock(_lock);
+        string::_buffer_type** cell = find_cell_for_addition(hash, buff->_bytes, buff->_size);
         if (*cell != NULL)
         {
-            buff->_ref_decrement();
+            buff->_ref_decrement(); // other owners keep it as not interned, equal interned buffers never coexist
             str._bytes = (*cell)->_bytes;
         }
         else
+        {
+            buff->_hash = hash;
+            buff->_capacity |= string::_interned_flag;
             *cell = buff;
+        }
         (*cell)->_ref_increment();
     }
 
-    string::_buffer_type* add(const char* str, unsigned size)
+    // With lower, add the string converted to lower case, which is done while copying it into the new buffer
+    //
+    string::_buffer_type* add(const char* str, unsigned size, bool lower = false)
     {
         if (size == 0)
         {
@@ -816,15 +927,19 @@ public:
             return &string::_empty_string_buffer; // special value, always interned
         }
 
-        unsigned hash = string::static_hash(str, size);
+        unsigned hash = lower ? string::static_hash_icase(str, size) : string::static_hash(str, size);
 
-        lock_guard<mutex> lock(_lock);
-        string::_buffer_type** cell = find_cell_for_addition(hash, str, size);
+        lock_guard<_intern_mutex_type> lock(_lock);
+        string::_buffer_type** cell = find_cell_for_addition(hash, str, size, lower);
         if (*cell == NULL)
         {
             string::_buffer_type* buff = string::_new_uninitialized_buffer(size, _adjust_capacity(size));
-            memcpy(buff->_bytes, str, size);
+            if (lower)
+                _simd_ascii_case(buff->_bytes, str, size, false);
+            else
+                memcpy(buff->_bytes, str, size);
             buff->_hash = hash;
+            buff->_capacity |= string::_interned_flag;
             *cell = buff;
         }
 
@@ -836,14 +951,16 @@ public:
     {
         if (_count != 0)
         {
-            lock_guard<mutex> lock(_lock);
+            lock_guard<_intern_mutex_type> lock(_lock);
             resize(_capacity);
         }
     }
 
     void resize(int new_capacity);
 
-    string::_buffer_type** find_cell_for_addition(unsigned hash, const char* bytes, unsigned size);
+    void merge(intern_staging* stagings, sstl_size_type count);
+
+    string::_buffer_type** find_cell_for_addition(unsigned hash, const char* bytes, unsigned size, bool lower = false);
 
     static _intern_holder* get_global()
     {
@@ -856,10 +973,12 @@ private:
     int _capacity; // has to be power of two
     int _count;
     string::_buffer_type** _buffers;
-    sstl::mutex _lock;
+    _intern_mutex_type _lock;
 };
 
-string::_buffer_type** _intern_holder::find_cell_for_addition(unsigned hash, const char* bytes, unsigned size)
+// With lower, the item to find is the given bytes converted to lower case
+//
+string::_buffer_type** _intern_holder::find_cell_for_addition(unsigned hash, const char* bytes, unsigned size, bool lower)
 {
     if (_capacity <= (_count << 1))
         resize(_capacity == 0 ? hashtable_default_size : _capacity + _capacity);
@@ -875,7 +994,7 @@ string::_buffer_type** _intern_holder::find_cell_for_addition(unsigned hash, con
             ++_count;  // we know there will be a new item
             return bb;  // empty place to add the new item
         }
-        if ( b->_hash == hash && b->_size == size && memcmp(b->_bytes, bytes, size) == 0 )
+        if ( b->_hash == hash && b->_size == size && (lower ? _simd_equal_lower(b->_bytes, bytes, size) : memcmp(b->_bytes, bytes, size) == 0) )
             return bb;  // the same item is found
 
         // Otherwise calculate the second-grade hash value, derivative from one given
@@ -914,11 +1033,11 @@ void _intern_holder::resize(int new_capacity)
                 {
                     SSTL_ASSERT(buff->_ref_count > 0);
 
-                    int index = static_cast<int>(buff->_hash & (_capacity - 1u)); // normalize hash into index
+                    int index = static_cast<int>(buff->_hash & (new_capacity - 1u)); // normalize hash into index
                     string::_buffer_type** bb;
                     for (;;)
                     {
-                        bb = &_buffers[index];
+                        bb = &new_buffers[index];
                         const string::_buffer_type* b = *bb;
                         if (b == NULL)
                         {
@@ -930,7 +1049,7 @@ void _intern_holder::resize(int new_capacity)
                         // Otherwise calculate the second-grade hash value, derivative from one given
                         index -= hashtable_secondary_shift;
                         if ( index < 0 ) // assume proper overflow behavior...
-                            index += _capacity;
+                            index += new_capacity;
                     }
                 }
             }
@@ -943,20 +1062,173 @@ void _intern_holder::resize(int new_capacity)
     _capacity = new_capacity;
 }
 
+void _intern_holder::merge(intern_staging* stagings, sstl_size_type count)
+{
+    lock_guard<_intern_mutex_type> lock(_lock);
+
+    int total = _count;
+    for (sstl_size_type i = 0; i < count; ++i)
+        total += static_cast<int>(stagings[i]._count);
+    int new_capacity = _capacity == 0 ? hashtable_default_size : _capacity;
+    while (new_capacity <= (total << 1)) // the same load factor as in find_cell_for_addition
+        new_capacity += new_capacity;
+    if (new_capacity != _capacity)
+        resize(new_capacity);
+
+    for (sstl_size_type i = 0; i < count; ++i)
+    {
+        intern_staging& staging = stagings[i];
+        SSTL_ASSERT(!staging._merged);
+        for (sstl_size_type j = 0; j < staging._count; ++j)
+        {
+            string::_buffer_type* buff = staging._items[j];
+            if (buff == &string::_empty_string_buffer) // not in the table, as in add
+                continue;
+            const unsigned hash = staging._hashes[j];
+            string::_buffer_type** cell = find_cell_for_addition(hash, buff->_bytes, buff->_size);
+            if (*cell == NULL)
+            {
+                buff->_hash = hash;
+                buff->_capacity |= string::_interned_flag;
+                *cell = buff;
+            }
+            else // already interned, possibly from another staging table
+            {
+                buff->_ref_decrement();
+                staging._items[j] = *cell;
+            }
+            (*cell)->_ref_increment(); // staging table keeps its reference
+        }
+        staging._merged = true;
+    }
+}
+
+intern_staging::intern_staging()
+    :
+      _items(NULL),
+      _hashes(NULL),
+      _count(0),
+      _items_capacity(0),
+      _table(NULL),
+      _table_capacity(0),
+      _merged(false)
+{}
+
+intern_staging::~intern_staging()
+{
+    clear();
+    delete [] _items;
+    delete [] _hashes;
+    delete [] _table;
+}
+
+intern_staging::size_type intern_staging::add(const char* s, size_type size)
+{
+    SSTL_ASSERT(!_merged); // call clear() to reuse the table after merging
+    if (_table_capacity <= (_count << 1))
+        _grow_table();
+
+    const unsigned hash = string::static_hash(s, size);
+    size_type index = hash & (_table_capacity - 1u);
+    for (;;)
+    {
+        const size_type item = _table[index];
+        if (item == 0)
+            break;
+        const string::_buffer_type* b = _items[item - 1];
+        if (_hashes[item - 1] == hash && b->_size == size && memcmp(b->_bytes, s, size) == 0)
+            return item - 1; // duplicate
+        index = (index - _intern_holder::hashtable_secondary_shift) & (_table_capacity - 1u);
+    }
+
+    if (_count == _items_capacity)
+    {
+        const size_type new_capacity = _items_capacity == 0 ? 64 : _items_capacity * 2;
+        string::_buffer_type** items = new string::_buffer_type*[new_capacity];
+        unsigned* hashes = new unsigned[new_capacity];
+        if (_count != 0)
+        {
+            memcpy(items, _items, _count * sizeof(*items));
+            memcpy(hashes, _hashes, _count * sizeof(*hashes));
+        }
+        delete [] _items;
+        delete [] _hashes;
+        _items = items;
+        _hashes = hashes;
+        _items_capacity = new_capacity;
+    }
+
+    string::_buffer_type* buff;
+    if (size == 0)
+    {
+        string::_empty_string_buffer._ref_increment(); // always interned, merge leaves it alone
+        buff = &string::_empty_string_buffer;
+    }
+    else
+    {
+        buff = string::_new_uninitialized_buffer(size, _adjust_capacity(size));
+        memcpy(buff->_bytes, s, size);
+    }
+    _items[_count] = buff;
+    _hashes[_count] = hash;
+    _table[index] = ++_count;
+    return _count - 1;
+}
+
+string intern_staging::operator[](size_type index) const
+{
+    SSTL_ASSERT(_merged); // only interned strings are given away
+    SSTL_ASSERT(index < _count);
+    string::_buffer_type* buff = _items[index];
+    buff->_ref_increment();
+    return string(buff);
+}
+
+void intern_staging::clear()
+{
+    for (size_type i = 0; i < _count; ++i)
+        _items[i]->_ref_decrement();
+    _count = 0;
+    _merged = false;
+    if (_table != NULL)
+        memset(_table, 0, _table_capacity * sizeof(*_table));
+}
+
+void intern_staging::_grow_table()
+{
+    const size_type new_capacity = _table_capacity == 0 ? 128 : _table_capacity * 2;
+    delete [] _table;
+    _table = new size_type[new_capacity];
+    _table_capacity = new_capacity;
+    memset(_table, 0, new_capacity * sizeof(*_table));
+    for (size_type i = 0; i < _count; ++i) // items are unique, only find an empty cell
+    {
+        size_type index = _hashes[i] & (new_capacity - 1u);
+        while (_table[index] != 0)
+            index = (index - _intern_holder::hashtable_secondary_shift) & (new_capacity - 1u);
+        _table[index] = i + 1;
+    }
+}
+
+void string::intern_merge(intern_staging* stagings, size_type count)
+{
+    _intern_holder::get_global()->merge(stagings, count);
+}
+
 void string::intern()
 {
     if (!is_interned())
         _intern_holder::get_global()->add(*this);
 }
 
-string string::intern_create(const char* s)
+string string::intern_create(const char* s, size_type size)
 {
-    return _intern_holder::get_global()->add(s, static_cast<size_type>(strlen(s)));
+    return _intern_holder::get_global()->add(s, size);
 }
 
-string string::intern_create(const char* s, size_type size)
+string string::intern_create_icase(const char* s, size_type size)
 {
-    return _intern_holder::get_global()->add(s, size);
+    return _intern_holder::get_global()->add(s, size, true);
 }
 
 void string::intern_cleanup(time_t secondsSincePrevious)
@@ -0,0 +1,119 @@
+#include "../string_builder"
+
+namespace SSTL_NAMESPACE {
+
+const string_builder::size_type string_builder::_default_chunk_size;
+const string_builder::size_type string_builder::_max_chunks;
+
+string_builder::string_builder(size_type expected_size)
+    :
+      _count(0),
+      _size(0),
+      _total_capacity(0),
+      _first_chunk_size(expected_size != 0 ? expected_size : _default_chunk_size)
+{
+    if (expected_size != 0)
+        _add_chunk(expected_size);
+}
+
+string_builder::~string_builder()
+{
+    _release_chunks(0);
+}
+
+string::_buffer_type* string_builder::_add_chunk(size_type minimum)
+{
+    SSTL_ASSERT(_count < _max_chunks);
+    const size_type wanted = _count == 0 ? _first_chunk_size : _total_capacity;
+    const size_type capacity = string::_exact_capacity(minimum > wanted ? minimum : wanted); // the first chunk may become a string
+    string::_buffer_type* chunk = string::_new_uninitialized_buffer(0, capacity);
+    _chunks[_count++] = chunk;
+    _total_capacity += capacity;
+    return chunk;
+}
+
+void string_builder::_release_chunks(size_type first)
+{
+    for (size_type i = first; i < _count; ++i)
+    {
+        _total_capacity -= _chunks[i]->_capacity;
+        _chunks[i]->_ref_decrement(); // the only reference
+    }
+    _count = first;
+}
+
+string_builder& string_builder::append(const char* s, size_type count)
+{
+    // What does not fit into the current chunk goes to the next one, no contiguous room is needed
+    string::_buffer_type* chunk = _count != 0 ? _chunks[_count - 1] : NULL;
+    if (chunk != NULL)
+    {
+        const size_type room = chunk->_capacity - chunk->_size;
+        const size_type part = count < room ? count : room;
+        memcpy(chunk->_bytes + chunk->_size, s, part);
+        chunk->_size += part;
+        _size += part;
+        s += part;
+        count -= part;
+    }
+    if (count != 0)
+        memcpy(append_uninitialized(count), s, count);
+    return *this;
+}
+
+string_builder& string_builder::append(size_type count, char c)
+{
+    if (count != 0)
+        memset(append_uninitialized(count), c, count);
+    return *this;
+}
+
+string string_builder::freeze()
+{
+    if (_size == 0)
+    {
+        clear();
+        return string();
+    }
+
+    string::_buffer_type* result;
+    if (_count == 1 && _chunks[0]->_capacity <= string::_exact_capacity(_size) + _size / 8)
+    {
+        // The payload fits into the first chunk with little to spare, the chunk becomes the string
+        result = _chunks[0];
+        _count = 0;
+        _total_capacity = 0;
+    }
+    else
+    {
+        result = string::_new_uninitialized_buffer(_size, string::_exact_capacity(_size));
+        char* p = result->_bytes;
+        for (size_type i = 0; i < _count; ++i)
+        {
+            memcpy(p, _chunks[i]->_bytes, _chunks[i]->_size);
+            p += _chunks[i]->_size;
+        }
+        _release_chunks(0);
+    }
+    _size = 0;
+    return string(result);
+}
+
+string string_builder::freeze_interned()
+{
+    string result = freeze();
+    result.intern();
+    return result;
+}
+
+void string_builder::clear()
+{
+    if (_count != 0)
+    {
+        _release_chunks(1);
+        _chunks[0]->_size = 0;
+    }
+    _size = 0;
+}
+
+}
@@ -0,0 +1,224 @@
+#include "../string_sort"
+
+namespace SSTL_NAMESPACE {
+
+// String being sorted, with its next eight bytes at the current depth
+//
+struct _string_sort_entry
+{
+    sstl_uint64 key;        // bytes at the depth in big endian order, zero padded
+    const char* data;
+    sstl_size_type size;
+    sstl_size_type index;   // position in the input
+    unsigned length;        // number of bytes of the key, fewer than eight only at the end of the string
+};
+
+struct _string_sort_task
+{
+    sstl_size_type begin;
+    sstl_size_type end;
+    sstl_size_type depth;
+};
+
+static const sstl_size_type _string_sort_insertion_limit = 16;
+
+static inline void _string_sort_load(_string_sort_entry& e, sstl_size_type depth)
+{
+    SSTL_ASSERT(depth <= e.size);
+    const sstl_size_type remaining = e.size - depth;
+    const unsigned length = remaining < 8 ? static_cast<unsigned>(remaining) : 8;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(e.data + depth);
+    sstl_uint64 key = 0;
+    for (unsigned i = 0; i < length; ++i)
+        key |= static_cast<sstl_uint64>(p[i]) << (56 - 8 * i);
+    e.key = key;
+    e.length = length;
+}
+
+// Order of the keys: a shorter key is a prefix of the longer one when the padded bytes are equal
+//
+static inline int _string_sort_compare_keys(const _string_sort_entry& a, const _string_sort_entry& b)
+{
+    if (a.key != b.key)
+        return a.key < b.key ? -1 : 1;
+    if (a.length != b.length)
+        return a.length < b.length ? -1 : 1;
+    return 0;
+}
+
+static int _string_sort_compare(const _string_sort_entry& a, const _string_sort_entry& b, sstl_size_type depth)
+{
+    const int result = _string_sort_compare_keys(a, b);
+    if (result != 0 || a.length < 8)
+        return result;
+    depth += 8;
+    const sstl_size_type a_remaining = a.size - depth;
+    const sstl_size_type b_remaining = b.size - depth;
+    const int bytes = memcmp(a.data + depth, b.data + depth, a_remaining < b_remaining ? a_remaining : b_remaining);
+    if (bytes != 0)
+        return bytes;
+    return a_remaining < b_remaining ? -1 : (a_remaining > b_remaining ? 1 : 0);
+}
+
+static void _string_sort_insertion(_string_sort_entry* entries, sstl_size_type count, sstl_size_type depth)
+{
+    for (sstl_size_type i = 1; i < count; ++i)
+    {
+        const _string_sort_entry e = entries[i];
+        sstl_size_type j = i;
+        for ( ; j > 0 && _string_sort_compare(e, entries[j - 1], depth) < 0; --j)
+            entries[j] = entries[j - 1];
+        entries[j] = e;
+    }
+}
+
+static inline const _string_sort_entry& _string_sort_median(const _string_sort_entry& a, const _string_sort_entry& b, const _string_sort_entry& c)
+{
+    if (_string_sort_compare_keys(a, b) < 0)
+    {
+        if (_string_sort_compare_keys(b, c) < 0)
+            return b;
+        return _string_sort_compare_keys(a, c) < 0 ? c : a;
+    }
+    if (_string_sort_compare_keys(a, c) < 0)
+        return a;
+    return _string_sort_compare_keys(b, c) < 0 ? c : b;
+}
+
+static void _string_sort_entries(_string_sort_entry* entries, sstl_size_type count)
+{
+    if (count < 2)
+        return;
+    for (sstl_size_type i = 0; i < count; ++i)
+        _string_sort_load(entries[i], 0);
+
+    // Explicit stack of partitions, the smaller of the outer ones is taken first
+    sstl_size_type stack_capacity = 64;
+    _string_sort_task* stack = new _string_sort_task[stack_capacity];
+    sstl_size_type stack_size = 0;
+    _string_sort_task task = {0, count, 0};
+    for (;;)
+    {
+        _string_sort_entry* e = entries + task.begin;
+        const sstl_size_type n = task.end - task.begin;
+        if (n <= _string_sort_insertion_limit)
+        {
+            _string_sort_insertion(e, n, task.depth);
+            if (stack_size == 0)
+                break;
+            task = stack[--stack_size];
+            continue;
+        }
+
+        // Three way partition on the key: [0, lt) less, [lt, gt) equal, [gt, n) greater
+        const _string_sort_entry pivot = _string_sort_median(e[0], e[n / 2], e[n - 1]);
+        sstl_size_type lt = 0;
+        sstl_size_type gt = n;
+        for (sstl_size_type i = 0; i < gt; )
+        {
+            const int c = _string_sort_compare_keys(e[i], pivot);
+            if (c < 0)
+            {
+                const _string_sort_entry t = e[i];
+                e[i++] = e[lt];
+                e[lt++] = t;
+            }
+            else if (c > 0)
+            {
+                const _string_sort_entry t = e[i];
+                e[i] = e[--gt];
+                e[gt] = t;
+            }
+            else
+                ++i;
+        }
+
+        if (stack_size + 3 > stack_capacity)
+        {
+            _string_sort_task* grown = new _string_sort_task[stack_capacity * 2];
+            memcpy(grown, stack, stack_size * sizeof(*stack));
+            delete [] stack;
+            stack = grown;
+            stack_capacity *= 2;
+        }
+
+        // Equal keys of eight bytes continue with the next eight, shorter ones are whole equal strings
+        if (pivot.length == 8 && gt - lt > 1)
+        {
+            const sstl_size_type depth = task.depth + 8;
+            for (sstl_size_type i = lt; i < gt; ++i)
+                _string_sort_load(e[i], depth);
+            const _string_sort_task middle = {task.begin + lt, task.begin + gt, depth};
+            stack[stack_size++] = middle;
+        }
+        const _string_sort_task less = {task.begin, task.begin + lt, task.depth};
+        const _string_sort_task greater = {task.begin + gt, task.end, task.depth};
+        const bool less_first = lt < n - gt;
+        const _string_sort_task& larger = less_first ? greater : less;
+        if (larger.end - larger.begin > 1)
+            stack[stack_size++] = larger;
+        task = less_first ? less : greater;
+    }
+    delete [] stack;
+}
+
+void sort_strings(string* first, string* last)
+{
+    SSTL_ASSERT(first <= last);
+    const sstl_size_type count = static_cast<sstl_size_type>(last - first);
+    if (count < 2)
+        return;
+    _string_sort_entry* entries = new _string_sort_entry[count];
+    for (sstl_size_type i = 0; i < count; ++i)
+    {
+        entries[i].data = first[i].data();
+        entries[i].size = first[i].size();
+        entries[i].index = i;
+    }
+    _string_sort_entries(entries, count);
+
+    // Move the strings along the cycles of the permutation, swapping only buffer pointers
+    for (sstl_size_type i = 0; i < count; ++i)
+    {
+        if (entries[i].index == i)
+            continue;
+        string held;
+        held.swap(first[i]);
+        sstl_size_type j = i;
+        for (;;)
+        {
+            const sstl_size_type k = entries[j].index;
+            entries[j].index = j;
+            if (k == i)
+            {
+                first[j].swap(held);
+                break;
+            }
+            first[j].swap(first[k]);
+            j = k;
+        }
+    }
+    delete [] entries;
+}
+
+void sort_strings(const char** strings, sstl_size_type* sizes, sstl_size_type count)
+{
+    if (count < 2)
+        return;
+    _string_sort_entry* entries = new _string_sort_entry[count];
+    for (sstl_size_type i = 0; i < count; ++i)
+    {
+        entries[i].data = strings[i];
+        entries[i].size = sizes[i];
+        entries[i].index = i;
+    }
+    _string_sort_entries(entries, count);
+    for (sstl_size_type i = 0; i < count; ++i)
+    {
+        strings[i] = entries[i].data;
+        sizes[i] = entries[i].size;
+    }
+    delete [] entries;
+}
+
+}
@@ -0,0 +1,117 @@
+#include "../string_view"
+#include "../string"
+#include "../algorithm"
+#include "../sstl_simd.h"
+
+namespace SSTL_NAMESPACE {
+
+const string_view::size_type string_view::npos;
+
+unsigned string_view::hash() const
+{
+    return string::static_hash(_data, _size);
+}
+
+string_view::size_type string_view::find(char ch, size_type pos) const
+{
+    if (pos < _size) // when pos >= size() return npos, as specified
+    {
+        const char* f = _simd_find_byte(_data + pos, _data + _size, ch);
+        if (f != _data + _size)
+            return static_cast<size_type>(f - _data);
+    }
+    return npos;
+}
+
+string_view::size_type string_view::find(const char* s, size_type pos, size_type count) const
+{
+    SSTL_ASSERT(s != NULL || count == 0);
+    if (_size - pos >= count && pos <= _size)
+    {
+        if (count == 0) // this has to happen after the above if
+            return pos;
+        const char* d_end = _data + _size;
+        const char* f = SSTL_NAMESPACE::search(_data + pos, d_end, s, s + count);
+        if (f < d_end)
+            return static_cast<size_type>(f - _data);
+    }
+    return npos;
+}
+
+string_view::size_type string_view::rfind(char ch, size_type pos) const
+{
+    if (_size != 0)
+    {
+        const char* d_end = _data + (pos < _size ? pos + 1 : _size);
+        const char* f = _simd_rfind_byte(_data, d_end, ch);
+        if (f != d_end)
+            return static_cast<size_type>(f - _data);
+    }
+    return npos;
+}
+
+string_view::size_type string_view::rfind(const char* s, size_type pos, size_type count) const
+{
+    SSTL_ASSERT(s != NULL || count == 0);
+    if (pos < _size && _size - pos >= count)
+        pos += count;
+    else
+        pos = _size;
+    if (count == 0)
+        return pos;
+
+    const char* d_end = _data + pos;
+    const char* f = SSTL_NAMESPACE::find_end(_data, d_end, s, s + count);
+    if (f < d_end)
+        return static_cast<size_type>(f - _data);
+    return npos;
+}
+
+// The find_..._of family searches for bytes of a set with the vector classification from sstl_simd.h
+
+static sstl_size_type _find_of(const char* d, sstl_size_type size, const char* s, sstl_size_type pos, sstl_size_type count, bool negate)
+{
+    SSTL_ASSERT(s != NULL || count == 0);
+    if (pos < size)
+    {
+        const char* f = _simd_find_of(d + pos, d + size, s, count, negate);
+        if (f != d + size)
+            return static_cast<sstl_size_type>(f - d);
+    }
+    return string_view::npos;
+}
+
+static sstl_size_type _rfind_of(const char* d, sstl_size_type size, const char* s, sstl_size_type pos, sstl_size_type count, bool negate)
+{
+    SSTL_ASSERT(s != NULL || count == 0);
+    if (size != 0)
+    {
+        const char* d_end = d + (pos < size ? pos + 1 : size);
+        const char* f = _simd_rfind_of(d, d_end, s, count, negate);
+        if (f != d_end)
+            return static_cast<sstl_size_type>(f - d);
+    }
+    return string_view::npos;
+}
+
+string_view::size_type string_view::find_first_of(const char* s, size_type pos, size_type count) const
+{
+    return _find_of(_data, _size, s, pos, count, false);
+}
+
+string_view::size_type string_view::find_last_of(const char* s, size_type pos, size_type count) const
+{
+    return _rfind_of(_data, _size, s, pos, count, false);
+}
+
+string_view::size_type string_view::find_first_not_of(const char* s, size_type pos, size_type count) const
+{
+    return _find_of(_data, _size, s, pos, count, true);
+}
+
+string_view::size_type string_view::find_last_not_of(const char* s, size_type pos, size_type count) const
+{
+    return _rfind_of(_data, _size, s, pos, count, true);
+}
+
+}
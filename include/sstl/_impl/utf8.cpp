@@ -0,0 +1,347 @@
+#include "../utf8"
+#include "../sstl_simd.h"
+
+namespace SSTL_NAMESPACE {
+
+// Length of the well formed sequence at p, zero if it is not well formed
+//
+static inline unsigned _utf8_sequence_length(const unsigned char* p, sstl_size_type remaining)
+{
+    const unsigned char c = p[0];
+    if (c < 0x80)
+        return 1;
+    unsigned length;
+    unsigned char second_min = 0x80;
+    unsigned char second_max = 0xBF;
+    if (c < 0xC2)       // continuation byte, or overlong form of ASCII
+        return 0;
+    else if (c < 0xE0)
+        length = 2;
+    else if (c < 0xF0)
+    {
+        length = 3;
+        if (c == 0xE0)
+            second_min = 0xA0; // overlong
+        else if (c == 0xED)
+            second_max = 0x9F; // surrogates
+    }
+    else if (c < 0xF5)
+    {
+        length = 4;
+        if (c == 0xF0)
+            second_min = 0x90; // overlong
+        else if (c == 0xF4)
+            second_max = 0x8F; // above U+10FFFF
+    }
+    else
+        return 0;
+    if (remaining < length || p[1] < second_min || p[1] > second_max)
+        return 0;
+    for (unsigned i = 2; i < length; ++i)
+        if ((p[i] & 0xC0) != 0x80)
+            return 0;
+    return length;
+}
+
+#if SSTL_SIMD_SSSE3 || SSTL_SIMD_NEON_TABLE
+
+// Vector validation by table lookups, after John Keiser and Daniel Lemire, "Validating UTF-8 in less than one instruction per byte".
+//
+// Every pair of adjacent bytes is classified by three 16 entry tables: high nibble of the first byte,
+// low nibble of the first byte and high nibble of the second byte. Each table gives a set of error bits
+// the pair might have, and the pair has an error if all three agree. Third and fourth bytes of
+// longer sequences are checked apart: they must be continuations exactly when two or three bytes back is a lead.
+
+static const unsigned char _utf8_too_short      = 1 << 0; // lead followed by ASCII or another lead
+static const unsigned char _utf8_too_long       = 1 << 1; // ASCII followed by continuation
+static const unsigned char _utf8_overlong_3     = 1 << 2;
+static const unsigned char _utf8_too_large      = 1 << 3;
+static const unsigned char _utf8_surrogate      = 1 << 4;
+static const unsigned char _utf8_overlong_2     = 1 << 5;
+static const unsigned char _utf8_too_large_1000 = 1 << 6;
+static const unsigned char _utf8_overlong_4     = 1 << 6;
+static const unsigned char _utf8_two_conts      = 1 << 7; // continuation followed by continuation, unless a longer sequence
+static const unsigned char _utf8_carry          = _utf8_too_short | _utf8_too_long | _utf8_two_conts;
+
+static const unsigned char _utf8_byte_1_high [ 16 ] =
+{
+    // 0xxx: ASCII
+    _utf8_too_long, _utf8_too_long, _utf8_too_long, _utf8_too_long,
+    _utf8_too_long, _utf8_too_long, _utf8_too_long, _utf8_too_long,
+    // 10xx: continuation
+    _utf8_two_conts, _utf8_two_conts, _utf8_two_conts, _utf8_two_conts,
+    // 1100, 1101: two byte lead
+    _utf8_too_short | _utf8_overlong_2,
+    _utf8_too_short,
+    // 1110: three byte lead
+    _utf8_too_short | _utf8_overlong_3 | _utf8_surrogate,
+    // 1111: four byte lead
+    _utf8_too_short | _utf8_too_large | _utf8_too_large_1000 | _utf8_overlong_4
+};
+
+static const unsigned char _utf8_byte_1_low [ 16 ] =
+{
+    _utf8_carry | _utf8_overlong_3 | _utf8_overlong_2 | _utf8_overlong_4, // xxxx0000
+    _utf8_carry | _utf8_overlong_2,                                      // xxxx0001
+    _utf8_carry,
+    _utf8_carry,
+    _utf8_carry | _utf8_too_large,                                       // xxxx0100
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000 | _utf8_surrogate, // xxxx1101
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000,
+    _utf8_carry | _utf8_too_large | _utf8_too_large_1000
+};
+
+static const unsigned char _utf8_byte_2_high [ 16 ] =
+{
+    // 0xxx: ASCII
+    _utf8_too_short, _utf8_too_short, _utf8_too_short, _utf8_too_short,
+    _utf8_too_short, _utf8_too_short, _utf8_too_short, _utf8_too_short,
+    // 1000
+    _utf8_too_long | _utf8_overlong_2 | _utf8_two_conts | _utf8_overlong_3 | _utf8_too_large_1000 | _utf8_overlong_4,
+    // 1001
+    _utf8_too_long | _utf8_overlong_2 | _utf8_two_conts | _utf8_overlong_3 | _utf8_too_large,
+    // 101x
+    _utf8_too_long | _utf8_overlong_2 | _utf8_two_conts | _utf8_surrogate | _utf8_too_large,
+    _utf8_too_long | _utf8_overlong_2 | _utf8_two_conts | _utf8_surrogate | _utf8_too_large,
+    // 11xx: lead
+    _utf8_too_short, _utf8_too_short, _utf8_too_short, _utf8_too_short
+};
+
+// Largest bytes allowed at the end of the input, the last three may not start a longer sequence
+static const unsigned char _utf8_max_last [ 16 ] =
+{
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF
+};
+
+#if SSTL_SIMD_SSSE3
+
+typedef __m128i _utf8_vector;
+
+static inline _utf8_vector _utf8_load(const void* p)                     {return _mm_loadu_si128(static_cast<const __m128i*>(p));}
+static inline void _utf8_store(void* p, _utf8_vector v)                  {_mm_storeu_si128(static_cast<__m128i*>(p), v);}
+static inline _utf8_vector _utf8_set1(unsigned char c)                   {return _mm_set1_epi8(static_cast<char>(c));}
+static inline _utf8_vector _utf8_zero()                                  {return _mm_setzero_si128();}
+static inline _utf8_vector _utf8_and(_utf8_vector a, _utf8_vector b)     {return _mm_and_si128(a, b);}
+static inline _utf8_vector _utf8_or(_utf8_vector a, _utf8_vector b)      {return _mm_or_si128(a, b);}
+static inline _utf8_vector _utf8_xor(_utf8_vector a, _utf8_vector b)     {return _mm_xor_si128(a, b);}
+static inline _utf8_vector _utf8_subs(_utf8_vector a, _utf8_vector b)    {return _mm_subs_epu8(a, b);}
+static inline _utf8_vector _utf8_lookup(_utf8_vector t, _utf8_vector i)  {return _mm_shuffle_epi8(t, i);}
+static inline _utf8_vector _utf8_high_nibbles(_utf8_vector v)            {return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));}
+static inline _utf8_vector _utf8_prev1(_utf8_vector v, _utf8_vector p)   {return _mm_alignr_epi8(v, p, 15);}
+static inline _utf8_vector _utf8_prev2(_utf8_vector v, _utf8_vector p)   {return _mm_alignr_epi8(v, p, 14);}
+static inline _utf8_vector _utf8_prev3(_utf8_vector v, _utf8_vector p)   {return _mm_alignr_epi8(v, p, 13);}
+static inline bool _utf8_is_ascii(_utf8_vector v)                        {return _mm_movemask_epi8(v) == 0;}
+static inline bool _utf8_is_zero(_utf8_vector v)                         {return _mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_setzero_si128())) == 0xFFFF;}
+
+#else
+
+typedef uint8x16_t _utf8_vector;
+
+static inline _utf8_vector _utf8_load(const void* p)                     {return vld1q_u8(static_cast<const unsigned char*>(p));}
+static inline void _utf8_store(void* p, _utf8_vector v)                  {vst1q_u8(static_cast<unsigned char*>(p), v);}
+static inline _utf8_vector _utf8_set1(unsigned char c)                   {return vdupq_n_u8(c);}
+static inline _utf8_vector _utf8_zero()                                  {return vdupq_n_u8(0);}
+static inline _utf8_vector _utf8_and(_utf8_vector a, _utf8_vector b)     {return vandq_u8(a, b);}
+static inline _utf8_vector _utf8_or(_utf8_vector a, _utf8_vector b)      {return vorrq_u8(a, b);}
+static inline _utf8_vector _utf8_xor(_utf8_vector a, _utf8_vector b)     {return veorq_u8(a, b);}
+static inline _utf8_vector _utf8_subs(_utf8_vector a, _utf8_vector b)    {return vqsubq_u8(a, b);}
+static inline _utf8_vector _utf8_lookup(_utf8_vector t, _utf8_vector i)  {return vqtbl1q_u8(t, i);}
+static inline _utf8_vector _utf8_high_nibbles(_utf8_vector v)            {return vshrq_n_u8(v, 4);}
+static inline _utf8_vector _utf8_prev1(_utf8_vector v, _utf8_vector p)   {return vextq_u8(p, v, 15);}
+static inline _utf8_vector _utf8_prev2(_utf8_vector v, _utf8_vector p)   {return vextq_u8(p, v, 14);}
+static inline _utf8_vector _utf8_prev3(_utf8_vector v, _utf8_vector p)   {return vextq_u8(p, v, 13);}
+static inline bool _utf8_is_ascii(_utf8_vector v)                        {return vmaxvq_u8(v) < 0x80;}
+static inline bool _utf8_is_zero(_utf8_vector v)                         {return vmaxvq_u8(v) == 0;}
+
+#endif
+
+struct _utf8_checker
+{
+    _utf8_vector error;
+    _utf8_vector previous;            // previous block
+    _utf8_vector previous_incomplete; // nonzero where the previous block ends inside a sequence
+    _utf8_vector byte_1_high;
+    _utf8_vector byte_1_low;
+    _utf8_vector byte_2_high;
+    _utf8_vector max_last;
+
+    _utf8_checker()
+        :
+          error(_utf8_zero()),
+          previous(_utf8_zero()),
+          previous_incomplete(_utf8_zero()),
+          byte_1_high(_utf8_load(_utf8_byte_1_high)),
+          byte_1_low(_utf8_load(_utf8_byte_1_low)),
+          byte_2_high(_utf8_load(_utf8_byte_2_high)),
+          max_last(_utf8_load(_utf8_max_last))
+    {}
+
+    void check(_utf8_vector input)
+    {
+        if (_utf8_is_ascii(input))
+        {
+            error = _utf8_or(error, previous_incomplete); // a sequence cannot continue with ASCII
+            previous_incomplete = _utf8_zero();
+        }
+        else
+        {
+            const _utf8_vector prev1 = _utf8_prev1(input, previous);
+            const _utf8_vector special = _utf8_and(_utf8_and(_utf8_lookup(byte_1_high, _utf8_high_nibbles(prev1)),
+                                                             _utf8_lookup(byte_1_low, _utf8_and(prev1, _utf8_set1(0x0F)))),
+                                                   _utf8_lookup(byte_2_high, _utf8_high_nibbles(input)));
+            const _utf8_vector third = _utf8_subs(_utf8_prev2(input, previous), _utf8_set1(0xE0 - 0x80)); // 0x80 or more only after 111xxxxx
+            const _utf8_vector fourth = _utf8_subs(_utf8_prev3(input, previous), _utf8_set1(0xF0 - 0x80)); // after 1111xxxx
+            const _utf8_vector must_continue = _utf8_and(_utf8_or(third, fourth), _utf8_set1(0x80));
+            error = _utf8_or(error, _utf8_xor(must_continue, special));
+            previous_incomplete = _utf8_subs(input, max_last);
+        }
+        previous = input;
+    }
+
+    bool finish()
+    {
+        return _utf8_is_zero(_utf8_or(error, previous_incomplete));
+    }
+};
+
+bool _utf8_copy_validate(char* dst, const char* src, sstl_size_type size)
+{
+    _utf8_checker checker;
+    sstl_size_type i = 0;
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const _utf8_vector input = _utf8_load(src + i);
+        if (dst != NULL)
+            _utf8_store(dst + i, input);
+        checker.check(input);
+    }
+    if (i < size)
+    {
+        // The tail is padded with zeros, which are ASCII and end any sequence
+        unsigned char tail [ 16 ];
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, src + i, size - i);
+        if (dst != NULL)
+            memcpy(dst + i, src + i, size - i);
+        checker.check(_utf8_load(tail));
+    }
+    return checker.finish();
+}
+
+#else
+
+bool _utf8_copy_validate(char* dst, const char* src, sstl_size_type size)
+{
+    if (dst != NULL)
+        memcpy(dst, src, size);
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(src);
+    const unsigned char* end = p + size;
+    while (p < end)
+    {
+        // ASCII blocks at once, a block with other bytes byte by byte to its end or a little further
+#if SSTL_SIMD_SSE2
+        if (end - p >= 16)
+        {
+            if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))) == 0)
+            {
+                p += 16;
+                continue;
+            }
+        }
+#elif SSTL_SIMD_NEON
+        if (end - p >= 16)
+        {
+            const uint8x16_t high = vshrq_n_u8(vld1q_u8(p), 7);
+            if (vget_lane_u64(vreinterpret_u64_u8(vorr_u8(vget_low_u8(high), vget_high_u8(high))), 0) == 0)
+            {
+                p += 16;
+                continue;
+            }
+        }
+#endif
+        const unsigned char* block_end = end - p > 64 ? p + 64 : end;
+        while (p < block_end)
+        {
+            if (*p < 0x80)
+            {
+                ++p;
+                continue;
+            }
+            const unsigned length = _utf8_sequence_length(p, static_cast<sstl_size_type>(end - p));
+            if (length == 0)
+                return false;
+            p += length;
+        }
+    }
+    return true;
+}
+
+#endif
+
+bool utf8_validate(const char* p, sstl_size_type size)
+{
+    return _utf8_copy_validate(NULL, p, size);
+}
+
+sstl_size_type utf8_length(const char* p, sstl_size_type size)
+{
+    // Count of the bytes that are not continuation bytes 10xxxxxx, that is signed bytes -64 and above
+    sstl_size_type result = 0;
+    sstl_size_type i = 0;
+#if SSTL_SIMD_SSE2
+    const __m128i limit = _mm_set1_epi8(-65);
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const unsigned leads = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, limit)));
+        result += _simd_popcount(leads);
+    }
+#elif SSTL_SIMD_NEON
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const int8x16_t v = vld1q_s8(reinterpret_cast<const signed char*>(p + i));
+        const uint8x16_t leads = vshrq_n_u8(vcgeq_s8(v, vdupq_n_s8(-64)), 7); // one for every lead byte
+        result += vaddvq_u8(leads);
+    }
+#endif
+    for ( ; i < size; ++i)
+        if (static_cast<signed char>(p[i]) >= -64)
+            ++result;
+    return result;
+}
+
+bool string::assign_utf8(const char* s, size_type size)
+{
+    if (size == 0)
+    {
+        clear();
+        return true;
+    }
+    bool valid;
+    if (is_shared() || capacity() < size)
+    {
+        char* bytes = _new_uninitialized(size);
+        valid = _utf8_copy_validate(bytes, s, size);
+        _get_buffer()->_ref_decrement();
+        _bytes = bytes;
+    }
+    else
+    {
+        _forget_hash();
+        _get_buffer()->_size = size;
+        valid = _utf8_copy_validate(_bytes, s, size);
+    }
+    if (!valid)
+        clear();
+    return valid;
+}
+
+}
@@ -21,6 +21,38 @@
 #endif
 ///@}
 
+///@{
+/// Size of the processor cache line in bytes
+///
+/// Data written by different threads, such as head and tail of concurrent queues,
+/// is padded to this size so that the threads do not invalidate each other's cache lines.
+#if !defined(SSTL_CONFIG_CACHE_LINE_SIZE)
+    #define SSTL_CONFIG_CACHE_LINE_SIZE 64
+#endif
+///@}
+
+///@{
+/// Collect lock contention statistics in SSTL internal locks
+///
+/// When enabled, internal locks such as the one of the string intern pool become
+/// sstl::profiled_mutex instances, and their statistics can be dumped through sstl::mutex_profile_registry.
+/// User code can use sstl::profiled_mutex independently of this option.
+#if !defined(SSTL_CONFIG_LOCK_PROFILING)
+    #define SSTL_CONFIG_LOCK_PROFILING 0
+#endif
+///@}
+
+///@{
+/// Use SIMD instructions in string and algorithm routines
+///
+/// The instruction set is selected at compile time from the compiler target options:
+/// SSE2 on x86 and x64, AVX2 if enabled with -mavx2 or /arch:AVX2, NEON on ARM.
+/// Set to 0 to use only portable scalar loops.
+#if !defined(SSTL_CONFIG_SIMD)
+    #define SSTL_CONFIG_SIMD 1
+#endif
+///@}
+
 ///@{
 /// Provide interoperability with compiler standard library.
 ///
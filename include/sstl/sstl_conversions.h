@@ -3,18 +3,28 @@
 
 // Extra data type conversion helpers
 
+#include "sstl_common.h"
+
+/// Conversion between arithmetic types that asserts the value is the same after it
+///
 template
   <typename To, typename From>
-To sstl_numeric_cast<To, From>(From v)
+inline To sstl_numeric_cast(From v)
 {
-
+    const To result = static_cast<To>(v);
+    SSTL_ASSERT(static_cast<From>(result) == v);
+    SSTL_ASSERT((v < From()) == (result < To())); // the sign is kept
+    return result;
 }
 
+/// Conversion of a size or a pointer difference to sstl_size_type, which is 32-bit even on 64-bit platforms
+///
 template
   <typename T>
-unsigned sstl_from_size_cast<T>(T v)
+inline sstl_size_type sstl_from_size_cast(T v)
 {
-
+    SSTL_ASSERT(v >= T() && static_cast<T>(static_cast<sstl_size_type>(v)) == v);
+    return static_cast<sstl_size_type>(v);
 }
 
 #endif
@@ -0,0 +1,1241 @@
+#ifndef _SSTL__SSTL_SIMD_INCLUDED
+#define _SSTL__SSTL_SIMD_INCLUDED
+
+// Internal SIMD kernels shared by string and algorithm routines.
+//
+// Exactly one of SSTL_SIMD_SSE2 and SSTL_SIMD_NEON is 1 when a vector instruction set is available,
+// SSTL_SIMD_SSSE3 and SSTL_SIMD_AVX2 are 1 additionally to SSE2 when byte shuffles
+// and 32-byte vectors can be used.
+// Every kernel has a scalar tail, so the functions work for any range length.
+
+#include "sstl_common.h"
+
+#if SSTL_CONFIG_SIMD && (defined(__AVX2__))
+    #define SSTL_SIMD_AVX2 1
+#else
+    #define SSTL_SIMD_AVX2 0
+#endif
+
+#if SSTL_CONFIG_SIMD && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SSTL_SIMD_SSE2 1
+#else
+    #define SSTL_SIMD_SSE2 0
+#endif
+
+#if SSTL_CONFIG_SIMD && !SSTL_SIMD_SSE2 && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #define SSTL_SIMD_NEON 1
+#else
+    #define SSTL_SIMD_NEON 0
+#endif
+
+// Byte shuffle: SSSE3 on x86, or the table lookup of AArch64
+#if SSTL_CONFIG_SIMD && SSTL_SIMD_SSE2 && (defined(__SSSE3__) || SSTL_SIMD_AVX2)
+    #define SSTL_SIMD_SSSE3 1
+#else
+    #define SSTL_SIMD_SSSE3 0
+#endif
+
+#if SSTL_SIMD_NEON && defined(__aarch64__)
+    #define SSTL_SIMD_NEON_TABLE 1
+#else
+    #define SSTL_SIMD_NEON_TABLE 0
+#endif
+
+#if SSTL_SIMD_AVX2
+    #include <immintrin.h>
+#elif SSTL_SIMD_SSSE3
+    #include <tmmintrin.h>
+#elif SSTL_SIMD_SSE2
+    #include <emmintrin.h>
+#elif SSTL_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#endif
+
+namespace SSTL_NAMESPACE {
+
+/// Index of the lowest set bit, the mask must not be zero
+///
+inline unsigned _simd_lowest_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+/// Index of the highest set bit, the mask must not be zero
+///
+inline unsigned _simd_highest_bit(unsigned mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return 31u - static_cast<unsigned>(__builtin_clz(mask));
+#endif
+}
+
+/// Index of the highest set bit of a 64-bit value, the value must not be zero
+///
+inline unsigned _simd_highest_bit64(sstl_uint64 value)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<unsigned>(index);
+#elif defined(_MSC_VER)
+    const unsigned high = static_cast<unsigned>(value >> 32);
+    return high != 0 ? 32u + _simd_highest_bit(high) : _simd_highest_bit(static_cast<unsigned>(value));
+#else
+    return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#endif
+}
+
+/// Number of set bits
+///
+inline unsigned _simd_popcount(unsigned mask)
+{
+#if defined(_MSC_VER)
+    return static_cast<unsigned>(__popcnt(mask));
+#else
+    return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+}
+
+#if SSTL_SIMD_SSE2
+
+inline unsigned _simd_match_mask16(const char* p, __m128i needle)
+{
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), needle)));
+}
+
+#endif
+
+#if SSTL_SIMD_AVX2
+
+inline unsigned _simd_match_mask32(const char* p, __m256i needle)
+{
+    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), needle)));
+}
+
+#endif
+
+#if SSTL_SIMD_NEON
+
+// NEON has no movemask, narrowing the comparison result gives 4 bits per byte in a 64-bit mask
+//
+inline sstl_uint64 _simd_match_mask16(const char* p, uint8x16_t needle)
+{
+    const uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p)), needle);
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+}
+
+inline unsigned _simd_lowest_nibble(sstl_uint64 mask)
+{
+    return static_cast<unsigned>(__builtin_ctzll(mask)) >> 2;
+}
+
+inline unsigned _simd_highest_nibble(sstl_uint64 mask)
+{
+    return (63u - static_cast<unsigned>(__builtin_clzll(mask))) >> 2;
+}
+
+#endif
+
+/// First occurrence of the byte in the range, or end if there is none
+///
+/// Ranges of at least the vector size are scanned with full vectors, the last vector
+/// overlaps the already scanned bytes instead of falling back to a scalar tail.
+///
+inline const char* _simd_find_byte(const char* p, const char* end, char c)
+{
+#if SSTL_SIMD_AVX2
+    if (end - p >= 32)
+    {
+        const __m256i needle = _mm256_set1_epi8(c);
+        for ( ; end - p >= 32; p += 32)
+        {
+            const unsigned mask = _simd_match_mask32(p, needle);
+            if (mask != 0)
+                return p + _simd_lowest_bit(mask);
+        }
+        if (p != end)
+        {
+            p = end - 32;
+            const unsigned mask = _simd_match_mask32(p, needle);
+            if (mask != 0)
+                return p + _simd_lowest_bit(mask);
+        }
+        return end;
+    }
+#endif
+#if SSTL_SIMD_SSE2
+    if (end - p >= 16)
+    {
+        const __m128i needle = _mm_set1_epi8(c);
+        for ( ; end - p >= 64; p += 64) // long ranges: one branch per four vectors
+        {
+            const __m128i any = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), needle),
+                                                          _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)), needle)),
+                                             _mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 32)), needle),
+                                                          _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 48)), needle)));
+            if (_mm_movemask_epi8(any) != 0)
+                break; // the vector loop below finds the exact position
+        }
+        for ( ; end - p >= 16; p += 16)
+        {
+            const unsigned mask = _simd_match_mask16(p, needle);
+            if (mask != 0)
+                return p + _simd_lowest_bit(mask);
+        }
+        if (p != end)
+        {
+            p = end - 16;
+            const unsigned mask = _simd_match_mask16(p, needle);
+            if (mask != 0)
+                return p + _simd_lowest_bit(mask);
+        }
+        return end;
+    }
+#elif SSTL_SIMD_NEON
+    if (end - p >= 16)
+    {
+        const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+        for ( ; end - p >= 16; p += 16)
+        {
+            const sstl_uint64 mask = _simd_match_mask16(p, needle);
+            if (mask != 0)
+                return p + _simd_lowest_nibble(mask);
+        }
+        if (p != end)
+        {
+            p = end - 16;
+            const sstl_uint64 mask = _simd_match_mask16(p, needle);
+            if (mask != 0)
+                return p + _simd_lowest_nibble(mask);
+        }
+        return end;
+    }
+#endif
+    for ( ; p < end; ++p)
+        if (*p == c)
+            return p;
+    return end;
+}
+
+/// Last occurrence of the byte in the range, or end if there is none
+///
+inline const char* _simd_rfind_byte(const char* begin, const char* end, char c)
+{
+    const char* p = end; // bytes from p to end are already scanned
+#if SSTL_SIMD_AVX2
+    if (p - begin >= 32)
+    {
+        const __m256i needle = _mm256_set1_epi8(c);
+        for ( ; p - begin >= 32; p -= 32)
+        {
+            const unsigned mask = _simd_match_mask32(p - 32, needle);
+            if (mask != 0)
+                return p - 32 + _simd_highest_bit(mask);
+        }
+        if (p != begin)
+        {
+            const unsigned mask = _simd_match_mask32(begin, needle);
+            if (mask != 0)
+                return begin + _simd_highest_bit(mask);
+        }
+        return end;
+    }
+#endif
+#if SSTL_SIMD_SSE2
+    if (p - begin >= 16)
+    {
+        const __m128i needle = _mm_set1_epi8(c);
+        for ( ; p - begin >= 64; p -= 64)
+        {
+            const __m128i any = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 64)), needle),
+                                                          _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 48)), needle)),
+                                             _mm_or_si128(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 32)), needle),
+                                                          _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p - 16)), needle)));
+            if (_mm_movemask_epi8(any) != 0)
+                break;
+        }
+        for ( ; p - begin >= 16; p -= 16)
+        {
+            const unsigned mask = _simd_match_mask16(p - 16, needle);
+            if (mask != 0)
+                return p - 16 + _simd_highest_bit(mask);
+        }
+        if (p != begin)
+        {
+            const unsigned mask = _simd_match_mask16(begin, needle);
+            if (mask != 0)
+                return begin + _simd_highest_bit(mask);
+        }
+        return end;
+    }
+#elif SSTL_SIMD_NEON
+    if (p - begin >= 16)
+    {
+        const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+        for ( ; p - begin >= 16; p -= 16)
+        {
+            const sstl_uint64 mask = _simd_match_mask16(p - 16, needle);
+            if (mask != 0)
+                return p - 16 + _simd_highest_nibble(mask);
+        }
+        if (p != begin)
+        {
+            const sstl_uint64 mask = _simd_match_mask16(begin, needle);
+            if (mask != 0)
+                return begin + _simd_highest_nibble(mask);
+        }
+        return end;
+    }
+#endif
+    while (p != begin)
+        if (*--p == c)
+            return p;
+    return end;
+}
+
+// Whether the pattern matches at p, the first and the last bytes are already known to match
+//
+inline bool _simd_match_middle(const char* p, const char* pattern, sstl_size_type size)
+{
+    return size <= 2 || memcmp(p + 1, pattern + 1, size - 2) == 0;
+}
+
+/// First occurrence of a short pattern, at least two bytes long, or end if there is none
+///
+/// Candidate positions are found with vectors comparing the first and the last byte of the pattern
+/// at once for 16 or 32 consecutive positions, and only the candidates are compared completely.
+/// The time is linear in the range size with the factor at most the pattern size,
+/// so this is intended for short patterns only.
+///
+inline const char* _simd_search_short(const char* p, const char* end, const char* pattern, sstl_size_type size)
+{
+    SSTL_ASSERT(size >= 2 && end - p >= static_cast<sstl_difference_type>(size));
+    const char* stop = end - size + 1; // one after the last position where the pattern fits
+#if SSTL_SIMD_AVX2
+    if (stop - p >= 32)
+    {
+        const __m256i first = _mm256_set1_epi8(pattern[0]);
+        const __m256i last = _mm256_set1_epi8(pattern[size - 1]);
+        for ( ; stop - p >= 32; p += 32)
+        {
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(
+                _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), first),
+                _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + size - 1)), last))));
+            for ( ; mask != 0; mask &= mask - 1)
+            {
+                const char* candidate = p + _simd_lowest_bit(mask);
+                if (_simd_match_middle(candidate, pattern, size))
+                    return candidate;
+            }
+        }
+    }
+#endif
+#if SSTL_SIMD_SSE2
+    if (stop - p >= 16)
+    {
+        const __m128i first = _mm_set1_epi8(pattern[0]);
+        const __m128i last = _mm_set1_epi8(pattern[size - 1]);
+        for ( ; stop - p >= 16; p += 16)
+        {
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), first),
+                _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + size - 1)), last))));
+            for ( ; mask != 0; mask &= mask - 1)
+            {
+                const char* candidate = p + _simd_lowest_bit(mask);
+                if (_simd_match_middle(candidate, pattern, size))
+                    return candidate;
+            }
+        }
+    }
+#elif SSTL_SIMD_NEON
+    if (stop - p >= 16)
+    {
+        const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(pattern[0]));
+        const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(pattern[size - 1]));
+        for ( ; stop - p >= 16; p += 16)
+        {
+            const uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p)), first),
+                                           vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p + size - 1)), last));
+            sstl_uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            for ( ; mask != 0; mask &= ~(static_cast<sstl_uint64>(0xF) << (_simd_lowest_nibble(mask) * 4)))
+            {
+                const char* candidate = p + _simd_lowest_nibble(mask);
+                if (_simd_match_middle(candidate, pattern, size))
+                    return candidate;
+            }
+        }
+    }
+#endif
+    for ( ; p != stop; ++p)
+        if (p[0] == pattern[0] && p[size - 1] == pattern[size - 1] && _simd_match_middle(p, pattern, size))
+            return p;
+    return end;
+}
+
+/// Last occurrence of a short pattern, at least two bytes long, or end if there is none
+///
+inline const char* _simd_rsearch_short(const char* begin, const char* end, const char* pattern, sstl_size_type size)
+{
+    SSTL_ASSERT(size >= 2 && end - begin >= static_cast<sstl_difference_type>(size));
+    const char* p = end - size + 1; // positions from p onwards are already checked
+#if SSTL_SIMD_AVX2
+    if (p - begin >= 32)
+    {
+        const __m256i first = _mm256_set1_epi8(pattern[0]);
+        const __m256i last = _mm256_set1_epi8(pattern[size - 1]);
+        for ( ; p - begin >= 32; p -= 32)
+        {
+            const char* block = p - 32;
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(
+                _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block)), first),
+                _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + size - 1)), last))));
+            while (mask != 0)
+            {
+                const unsigned bit = _simd_highest_bit(mask);
+                if (_simd_match_middle(block + bit, pattern, size))
+                    return block + bit;
+                mask &= ~(1u << bit);
+            }
+        }
+    }
+#endif
+#if SSTL_SIMD_SSE2
+    if (p - begin >= 16)
+    {
+        const __m128i first = _mm_set1_epi8(pattern[0]);
+        const __m128i last = _mm_set1_epi8(pattern[size - 1]);
+        for ( ; p - begin >= 16; p -= 16)
+        {
+            const char* block = p - 16;
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(
+                _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block)), first),
+                _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(block + size - 1)), last))));
+            while (mask != 0)
+            {
+                const unsigned bit = _simd_highest_bit(mask);
+                if (_simd_match_middle(block + bit, pattern, size))
+                    return block + bit;
+                mask &= ~(1u << bit);
+            }
+        }
+    }
+#elif SSTL_SIMD_NEON
+    if (p - begin >= 16)
+    {
+        const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(pattern[0]));
+        const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(pattern[size - 1]));
+        for ( ; p - begin >= 16; p -= 16)
+        {
+            const char* block = p - 16;
+            const uint8x16_t eq = vandq_u8(vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(block)), first),
+                                           vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(block + size - 1)), last));
+            sstl_uint64 mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            while (mask != 0)
+            {
+                const unsigned index = _simd_highest_nibble(mask);
+                if (_simd_match_middle(block + index, pattern, size))
+                    return block + index;
+                mask &= ~(static_cast<sstl_uint64>(0xF) << (index * 4));
+            }
+        }
+    }
+#endif
+    while (p != begin)
+    {
+        --p;
+        if (p[0] == pattern[0] && p[size - 1] == pattern[size - 1] && _simd_match_middle(p, pattern, size))
+            return p;
+    }
+    return end;
+}
+
+// Sets of bytes for find_first_of and the like
+//
+// The set is always kept as an exact 256-bit bitmap for scalar code.
+// Vector code classifies 16 bytes at once, either by looking up both nibbles of each byte
+// in two 16-byte tables with a byte shuffle, or by comparing with every byte of a small set.
+// The nibble tables give a bit to every distinct high nibble in the set, so they are exact
+// for sets with at most 8 distinct high nibbles, for example for any set of ASCII characters.
+
+struct _simd_byte_set
+{
+    unsigned char bitmap [ 32 ];
+    unsigned char chars [ 16 ];      // the first distinct bytes, enough for the comparison classifier
+    sstl_size_type distinct;         // number of distinct bytes
+    unsigned char nibble_low [ 16 ]; // for every low nibble, bits of high nibbles that make a byte of the set
+    unsigned char nibble_high [ 16 ];
+    unsigned high_nibble_count;
+
+    _simd_byte_set(const char* s, sstl_size_type count)
+        : distinct(0),
+          high_nibble_count(0)
+    {
+        memset(bitmap, 0, sizeof(bitmap));
+        memset(nibble_low, 0, sizeof(nibble_low));
+        memset(nibble_high, 0, sizeof(nibble_high));
+        for (sstl_size_type i = 0; i < count; ++i)
+        {
+            const unsigned char c = static_cast<unsigned char>(s[i]);
+            if (bitmap[c >> 3] & (1u << (c & 7)))
+                continue;
+            bitmap[c >> 3] |= static_cast<unsigned char>(1u << (c & 7));
+            if (distinct < sizeof(chars))
+                chars[distinct] = c;
+            ++distinct;
+            const unsigned high = c >> 4;
+            if (nibble_high[high] == 0)
+            {
+                if (high_nibble_count < 8)
+                    nibble_high[high] = static_cast<unsigned char>(1u << high_nibble_count);
+                ++high_nibble_count;
+            }
+            nibble_low[c & 15] |= nibble_high[high];
+        }
+    }
+
+    bool contains(char c) const
+    {
+        const unsigned char u = static_cast<unsigned char>(c);
+        return (bitmap[u >> 3] & (1u << (u & 7))) != 0;
+    }
+};
+
+#if SSTL_SIMD_SSE2
+
+typedef unsigned _simd_class_mask; // bit per byte
+static const _simd_class_mask _simd_class_mask_all = 0xFFFF;
+
+inline unsigned _simd_class_mask_first(_simd_class_mask mask) {return _simd_lowest_bit(mask);}
+inline unsigned _simd_class_mask_last(_simd_class_mask mask)  {return _simd_highest_bit(mask);}
+
+// Compares with every byte of a set of up to 16 bytes,
+// the set is padded with its first byte to a multiple of four comparisons
+//
+struct _simd_list_classifier
+{
+    __m128i chars [ 16 ];
+    sstl_size_type count;
+
+    explicit _simd_list_classifier(const _simd_byte_set& set)
+        : count((set.distinct + 3) & ~3u)
+    {
+        SSTL_ASSERT(set.distinct <= 16);
+        for (sstl_size_type i = 0; i < count; ++i)
+            chars[i] = _mm_set1_epi8(static_cast<char>(set.chars[i < set.distinct ? i : 0]));
+    }
+
+    _simd_class_mask mask16(const char* p) const
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i any = _mm_setzero_si128();
+        for (sstl_size_type i = 0; i < count; i += 4)
+            any = _mm_or_si128(any, _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, chars[i]), _mm_cmpeq_epi8(v, chars[i + 1])),
+                                                 _mm_or_si128(_mm_cmpeq_epi8(v, chars[i + 2]), _mm_cmpeq_epi8(v, chars[i + 3]))));
+        return static_cast<unsigned>(_mm_movemask_epi8(any));
+    }
+};
+
+#elif SSTL_SIMD_NEON
+
+typedef sstl_uint64 _simd_class_mask; // four bits per byte
+static const _simd_class_mask _simd_class_mask_all = ~static_cast<sstl_uint64>(0);
+
+inline unsigned _simd_class_mask_first(_simd_class_mask mask) {return _simd_lowest_nibble(mask);}
+inline unsigned _simd_class_mask_last(_simd_class_mask mask)  {return _simd_highest_nibble(mask);}
+
+inline _simd_class_mask _simd_class_mask_from(uint8x16_t eq)
+{
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+}
+
+struct _simd_list_classifier
+{
+    uint8x16_t chars [ 16 ];
+    sstl_size_type count;
+
+    explicit _simd_list_classifier(const _simd_byte_set& set)
+        : count((set.distinct + 3) & ~3u)
+    {
+        SSTL_ASSERT(set.distinct <= 16);
+        for (sstl_size_type i = 0; i < count; ++i)
+            chars[i] = vdupq_n_u8(set.chars[i < set.distinct ? i : 0]);
+    }
+
+    _simd_class_mask mask16(const char* p) const
+    {
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        uint8x16_t any = vdupq_n_u8(0);
+        for (sstl_size_type i = 0; i < count; i += 4)
+            any = vorrq_u8(any, vorrq_u8(vorrq_u8(vceqq_u8(v, chars[i]), vceqq_u8(v, chars[i + 1])),
+                                         vorrq_u8(vceqq_u8(v, chars[i + 2]), vceqq_u8(v, chars[i + 3]))));
+        return _simd_class_mask_from(any);
+    }
+};
+
+#endif
+
+#if SSTL_SIMD_SSSE3
+
+struct _simd_nibble_classifier
+{
+    __m128i low;
+    __m128i high;
+
+    explicit _simd_nibble_classifier(const _simd_byte_set& set)
+    {
+        SSTL_ASSERT(set.high_nibble_count <= 8);
+        low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.nibble_low));
+        high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(set.nibble_high));
+    }
+
+    _simd_class_mask mask16(const char* p) const
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i nibble = _mm_set1_epi8(0x0F);
+        const __m128i bits = _mm_and_si128(_mm_shuffle_epi8(low, _mm_and_si128(v, nibble)),
+                                           _mm_shuffle_epi8(high, _mm_and_si128(_mm_srli_epi16(v, 4), nibble)));
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bits, _mm_setzero_si128()))) ^ 0xFFFFu;
+    }
+};
+
+#elif SSTL_SIMD_NEON_TABLE
+
+struct _simd_nibble_classifier
+{
+    uint8x16_t low;
+    uint8x16_t high;
+
+    explicit _simd_nibble_classifier(const _simd_byte_set& set)
+    {
+        SSTL_ASSERT(set.high_nibble_count <= 8);
+        low = vld1q_u8(set.nibble_low);
+        high = vld1q_u8(set.nibble_high);
+    }
+
+    _simd_class_mask mask16(const char* p) const
+    {
+        const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+        const uint8x16_t bits = vandq_u8(vqtbl1q_u8(low, vandq_u8(v, vdupq_n_u8(0x0F))),
+                                         vqtbl1q_u8(high, vshrq_n_u8(v, 4)));
+        return _simd_class_mask_from(vtstq_u8(bits, bits));
+    }
+};
+
+#endif
+
+#if SSTL_SIMD_SSE2 || SSTL_SIMD_NEON
+
+// First byte of the range that is in the set, or not in the set if negate is true
+//
+template
+    <class C>
+const char* _simd_find_class(const char* p, const char* end, const C& classifier, bool negate)
+{
+    SSTL_ASSERT(end - p >= 16);
+    const _simd_class_mask flip = negate ? _simd_class_mask_all : 0;
+    for ( ; end - p >= 16; p += 16)
+    {
+        const _simd_class_mask mask = classifier.mask16(p) ^ flip;
+        if (mask != 0)
+            return p + _simd_class_mask_first(mask);
+    }
+    if (p != end)
+    {
+        p = end - 16; // overlaps the bytes without matches
+        const _simd_class_mask mask = classifier.mask16(p) ^ flip;
+        if (mask != 0)
+            return p + _simd_class_mask_first(mask);
+    }
+    return end;
+}
+
+template
+    <class C>
+const char* _simd_rfind_class(const char* begin, const char* end, const C& classifier, bool negate)
+{
+    SSTL_ASSERT(end - begin >= 16);
+    const _simd_class_mask flip = negate ? _simd_class_mask_all : 0;
+    const char* p = end;
+    for ( ; p - begin >= 16; p -= 16)
+    {
+        const _simd_class_mask mask = classifier.mask16(p - 16) ^ flip;
+        if (mask != 0)
+            return p - 16 + _simd_class_mask_last(mask);
+    }
+    if (p != begin)
+    {
+        const _simd_class_mask mask = classifier.mask16(begin) ^ flip;
+        if (mask != 0)
+            return begin + _simd_class_mask_last(mask);
+    }
+    return end;
+}
+
+#endif
+
+/// First byte of the range that is one of the count bytes of the set, or that is none of them
+/// if negate is true, or end if there is no such byte
+///
+inline const char* _simd_find_of(const char* p, const char* end, const char* set_bytes, sstl_size_type count, bool negate)
+{
+    if (count == 1 && !negate)
+        return _simd_find_byte(p, end, set_bytes[0]);
+    if (end - p < 16 && count <= 16) // building the set would take longer than the search
+    {
+        for ( ; p < end; ++p)
+            if ((memchr(set_bytes, *p, count) != NULL) != negate)
+                return p;
+        return end;
+    }
+    const _simd_byte_set set(set_bytes, count);
+    if (end - p >= 16)
+    {
+#if SSTL_SIMD_SSSE3 || SSTL_SIMD_NEON_TABLE
+        if (set.high_nibble_count <= 8)
+            return _simd_find_class(p, end, _simd_nibble_classifier(set), negate);
+#endif
+#if SSTL_SIMD_SSE2 || SSTL_SIMD_NEON
+        if (set.distinct <= 16)
+            return _simd_find_class(p, end, _simd_list_classifier(set), negate);
+#endif
+    }
+    for ( ; p < end; ++p)
+        if (set.contains(*p) != negate)
+            return p;
+    return end;
+}
+
+/// Last byte of the range that is one of the set, or that is none of them, or end if there is none
+///
+inline const char* _simd_rfind_of(const char* begin, const char* end, const char* set_bytes, sstl_size_type count, bool negate)
+{
+    if (count == 1 && !negate)
+        return _simd_rfind_byte(begin, end, set_bytes[0]);
+    if (end - begin < 16 && count <= 16)
+    {
+        for (const char* p = end; p != begin; )
+            if ((memchr(set_bytes, *--p, count) != NULL) != negate)
+                return p;
+        return end;
+    }
+    const _simd_byte_set set(set_bytes, count);
+    if (end - begin >= 16)
+    {
+#if SSTL_SIMD_SSSE3 || SSTL_SIMD_NEON_TABLE
+        if (set.high_nibble_count <= 8)
+            return _simd_rfind_class(begin, end, _simd_nibble_classifier(set), negate);
+#endif
+#if SSTL_SIMD_SSE2 || SSTL_SIMD_NEON
+        if (set.distinct <= 16)
+            return _simd_rfind_class(begin, end, _simd_list_classifier(set), negate);
+#endif
+    }
+    for (const char* p = end; p != begin; )
+        if (set.contains(*--p) != negate)
+            return p;
+    return end;
+}
+
+// Kernels for ranges of 32-bit elements: int, unsigned and float
+//
+// Equality of int and unsigned is the same as bitwise equality, so unsigned ranges use the int kernels
+// where only equality matters. Float kernels compare as floats, so 0.0 equals -0.0 and NaN equals nothing,
+// exactly as the scalar code does.
+
+#if SSTL_SIMD_SSE2
+
+typedef unsigned _simd_lane_mask; // bit per lane
+
+inline unsigned _simd_lane_first(_simd_lane_mask mask) {return _simd_lowest_bit(mask);}
+
+inline _simd_lane_mask _simd_lane_mask_of(__m128i eq) {return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(eq)));}
+inline _simd_lane_mask _simd_lane_mask_of(__m128 eq)  {return static_cast<unsigned>(_mm_movemask_ps(eq));}
+
+inline __m128i _simd_load_i32(const int* p)   {return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));}
+inline __m128  _simd_load_f32(const float* p) {return _mm_loadu_ps(p);}
+
+// Select a where the mask is set, otherwise b
+inline __m128i _simd_select_i32(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+#elif SSTL_SIMD_NEON
+
+typedef sstl_uint64 _simd_lane_mask; // 16 bits per lane
+
+inline unsigned _simd_lane_first(_simd_lane_mask mask) {return static_cast<unsigned>(__builtin_ctzll(mask)) >> 4;}
+
+inline _simd_lane_mask _simd_lane_mask_of(uint32x4_t eq) {return vget_lane_u64(vreinterpret_u64_u16(vmovn_u32(eq)), 0);}
+
+#endif
+
+inline const int* _simd_find_i32(const int* p, const int* end, int value)
+{
+#if SSTL_SIMD_SSE2
+    const __m128i v = _mm_set1_epi32(value);
+    for ( ; end - p >= 16; p += 16) // four vectors per branch
+    {
+        const __m128i any = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi32(_simd_load_i32(p), v), _mm_cmpeq_epi32(_simd_load_i32(p + 4), v)),
+                                         _mm_or_si128(_mm_cmpeq_epi32(_simd_load_i32(p + 8), v), _mm_cmpeq_epi32(_simd_load_i32(p + 12), v)));
+        if (_mm_movemask_epi8(any) != 0)
+            break;
+    }
+    for ( ; end - p >= 4; p += 4)
+    {
+        const _simd_lane_mask mask = _simd_lane_mask_of(_mm_cmpeq_epi32(_simd_load_i32(p), v));
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#elif SSTL_SIMD_NEON
+    const int32x4_t v = vdupq_n_s32(value);
+    for ( ; end - p >= 4; p += 4)
+    {
+        const _simd_lane_mask mask = _simd_lane_mask_of(vceqq_s32(vld1q_s32(p), v));
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#endif
+    for ( ; p < end; ++p)
+        if (*p == value)
+            return p;
+    return end;
+}
+
+inline const float* _simd_find_f32(const float* p, const float* end, float value)
+{
+#if SSTL_SIMD_SSE2
+    const __m128 v = _mm_set1_ps(value);
+    for ( ; end - p >= 4; p += 4)
+    {
+        const _simd_lane_mask mask = _simd_lane_mask_of(_mm_cmpeq_ps(_simd_load_f32(p), v));
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#elif SSTL_SIMD_NEON
+    const float32x4_t v = vdupq_n_f32(value);
+    for ( ; end - p >= 4; p += 4)
+    {
+        const _simd_lane_mask mask = _simd_lane_mask_of(vceqq_f32(vld1q_f32(p), v));
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#endif
+    for ( ; p < end; ++p)
+        if (*p == value)
+            return p;
+    return end;
+}
+
+inline sstl_size_type _simd_count_i32(const int* p, const int* end, int value)
+{
+    sstl_size_type result = 0;
+#if SSTL_SIMD_SSE2
+    if (end - p >= 4)
+    {
+        const __m128i v = _mm_set1_epi32(value);
+        __m128i counts = _mm_setzero_si128(); // lanes count down by one for every match
+        for ( ; end - p >= 4; p += 4)
+            counts = _mm_add_epi32(counts, _mm_cmpeq_epi32(_simd_load_i32(p), v));
+        int lanes [ 4 ];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        result = static_cast<sstl_size_type>(-(lanes[0] + lanes[1] + lanes[2] + lanes[3]));
+    }
+#elif SSTL_SIMD_NEON
+    if (end - p >= 4)
+    {
+        const int32x4_t v = vdupq_n_s32(value);
+        uint32x4_t counts = vdupq_n_u32(0);
+        for ( ; end - p >= 4; p += 4)
+            counts = vsubq_u32(counts, vceqq_s32(vld1q_s32(p), v)); // matches are all ones, that is minus one
+        result = vgetq_lane_u32(counts, 0) + vgetq_lane_u32(counts, 1) + vgetq_lane_u32(counts, 2) + vgetq_lane_u32(counts, 3);
+    }
+#endif
+    for ( ; p < end; ++p)
+        if (*p == value)
+            ++result;
+    return result;
+}
+
+inline sstl_size_type _simd_count_f32(const float* p, const float* end, float value)
+{
+    sstl_size_type result = 0;
+#if SSTL_SIMD_SSE2
+    if (end - p >= 4)
+    {
+        const __m128 v = _mm_set1_ps(value);
+        __m128i counts = _mm_setzero_si128();
+        for ( ; end - p >= 4; p += 4)
+            counts = _mm_add_epi32(counts, _mm_castps_si128(_mm_cmpeq_ps(_simd_load_f32(p), v)));
+        int lanes [ 4 ];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), counts);
+        result = static_cast<sstl_size_type>(-(lanes[0] + lanes[1] + lanes[2] + lanes[3]));
+    }
+#elif SSTL_SIMD_NEON
+    if (end - p >= 4)
+    {
+        const float32x4_t v = vdupq_n_f32(value);
+        uint32x4_t counts = vdupq_n_u32(0);
+        for ( ; end - p >= 4; p += 4)
+            counts = vsubq_u32(counts, vceqq_f32(vld1q_f32(p), v));
+        result = vgetq_lane_u32(counts, 0) + vgetq_lane_u32(counts, 1) + vgetq_lane_u32(counts, 2) + vgetq_lane_u32(counts, 3);
+    }
+#endif
+    for ( ; p < end; ++p)
+        if (*p == value)
+            ++result;
+    return result;
+}
+
+/// First position where the ranges differ, as a pointer into the first range, or end
+///
+inline const int* _simd_mismatch_i32(const int* p, const int* end, const int* q)
+{
+#if SSTL_SIMD_SSE2
+    for ( ; end - p >= 4; p += 4, q += 4)
+    {
+        const _simd_lane_mask mask = _simd_lane_mask_of(_mm_cmpeq_epi32(_simd_load_i32(p), _simd_load_i32(q))) ^ 0xFu;
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#elif SSTL_SIMD_NEON
+    for ( ; end - p >= 4; p += 4, q += 4)
+    {
+        const _simd_lane_mask mask = ~_simd_lane_mask_of(vceqq_s32(vld1q_s32(p), vld1q_s32(q)));
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#endif
+    for ( ; p < end; ++p, ++q)
+        if (*p != *q)
+            return p;
+    return end;
+}
+
+inline const float* _simd_mismatch_f32(const float* p, const float* end, const float* q)
+{
+#if SSTL_SIMD_SSE2
+    for ( ; end - p >= 4; p += 4, q += 4)
+    {
+        const _simd_lane_mask mask = _simd_lane_mask_of(_mm_cmpeq_ps(_simd_load_f32(p), _simd_load_f32(q))) ^ 0xFu;
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#elif SSTL_SIMD_NEON
+    for ( ; end - p >= 4; p += 4, q += 4)
+    {
+        const _simd_lane_mask mask = ~_simd_lane_mask_of(vceqq_f32(vld1q_f32(p), vld1q_f32(q)));
+        if (mask != 0)
+            return p + _simd_lane_first(mask);
+    }
+#endif
+    for ( ; p < end; ++p, ++q)
+        if (!(*p == *q))
+            return p;
+    return end;
+}
+
+inline void _simd_fill_i32(int* p, int* end, int value)
+{
+#if SSTL_SIMD_SSE2
+    const __m128i v = _mm_set1_epi32(value);
+    for ( ; end - p >= 4; p += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v);
+#elif SSTL_SIMD_NEON
+    const int32x4_t v = vdupq_n_s32(value);
+    for ( ; end - p >= 4; p += 4)
+        vst1q_s32(p, v);
+#endif
+    for ( ; p < end; ++p)
+        *p = value;
+}
+
+/// Smallest or largest value of a non-empty range
+///
+/// Unsigned values are compared as signed after flipping the sign bit, as SSE2 has only signed comparisons.
+///
+inline int _simd_extreme_i32(const int* p, const int* end, bool maximum, bool is_unsigned)
+{
+    SSTL_ASSERT(p < end);
+    const int bias = is_unsigned ? static_cast<int>(0x80000000u) : 0;
+    int result = *p ^ bias;
+#if SSTL_SIMD_SSE2
+    if (end - p >= 4)
+    {
+        const __m128i b = _mm_set1_epi32(bias);
+        __m128i best = _mm_xor_si128(_simd_load_i32(p), b);
+        for (p += 4; end - p >= 4; p += 4)
+        {
+            const __m128i v = _mm_xor_si128(_simd_load_i32(p), b);
+            const __m128i better = maximum ? _mm_cmpgt_epi32(v, best) : _mm_cmplt_epi32(v, best);
+            best = _simd_select_i32(better, v, best);
+        }
+        int lanes [ 4 ];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), best);
+        result = lanes[0];
+        for (int i = 1; i < 4; ++i)
+            if (maximum ? lanes[i] > result : lanes[i] < result)
+                result = lanes[i];
+    }
+#elif SSTL_SIMD_NEON
+    if (end - p >= 4)
+    {
+        const int32x4_t b = vdupq_n_s32(bias);
+        int32x4_t best = veorq_s32(vld1q_s32(p), b);
+        for (p += 4; end - p >= 4; p += 4)
+        {
+            const int32x4_t v = veorq_s32(vld1q_s32(p), b);
+            best = maximum ? vmaxq_s32(best, v) : vminq_s32(best, v);
+        }
+        int lanes [ 4 ];
+        vst1q_s32(lanes, best);
+        result = lanes[0];
+        for (int i = 1; i < 4; ++i)
+            if (maximum ? lanes[i] > result : lanes[i] < result)
+                result = lanes[i];
+    }
+#endif
+    for ( ; p < end; ++p)
+    {
+        const int v = *p ^ bias;
+        if (maximum ? v > result : v < result)
+            result = v;
+    }
+    return result ^ bias;
+}
+
+/// Smallest or largest value of a non-empty range, false if there is NaN in the range
+///
+inline bool _simd_extreme_f32(const float* p, const float* end, bool maximum, float& result)
+{
+    SSTL_ASSERT(p < end);
+    result = *p;
+    bool nan = result != result;
+#if SSTL_SIMD_SSE2
+    if (end - p >= 4)
+    {
+        __m128 best = _simd_load_f32(p);
+        __m128 unordered = _mm_cmpunord_ps(best, best);
+        for (p += 4; end - p >= 4; p += 4)
+        {
+            const __m128 v = _simd_load_f32(p);
+            unordered = _mm_or_ps(unordered, _mm_cmpunord_ps(v, v));
+            best = maximum ? _mm_max_ps(best, v) : _mm_min_ps(best, v);
+        }
+        nan = nan || _mm_movemask_ps(unordered) != 0;
+        float lanes [ 4 ];
+        _mm_storeu_ps(lanes, best);
+        result = lanes[0];
+        for (int i = 1; i < 4; ++i)
+            if (maximum ? lanes[i] > result : lanes[i] < result)
+                result = lanes[i];
+    }
+#elif SSTL_SIMD_NEON
+    if (end - p >= 4)
+    {
+        float32x4_t best = vld1q_f32(p);
+        uint32x4_t ordered = vceqq_f32(best, best);
+        for (p += 4; end - p >= 4; p += 4)
+        {
+            const float32x4_t v = vld1q_f32(p);
+            ordered = vandq_u32(ordered, vceqq_f32(v, v));
+            best = maximum ? vmaxq_f32(best, v) : vminq_f32(best, v);
+        }
+        nan = nan || ~_simd_lane_mask_of(ordered) != 0;
+        float lanes [ 4 ];
+        vst1q_f32(lanes, best);
+        result = lanes[0];
+        for (int i = 1; i < 4; ++i)
+            if (maximum ? lanes[i] > result : lanes[i] < result)
+                result = lanes[i];
+    }
+#endif
+    for ( ; p < end; ++p)
+    {
+        const float v = *p;
+        nan = nan || v != v;
+        if (maximum ? v > result : v < result)
+            result = v;
+    }
+    return !nan;
+}
+
+/// Sum of the range with the wrap around of unsigned arithmetic
+///
+inline unsigned _simd_sum_u32(const unsigned* p, const unsigned* end)
+{
+    unsigned result = 0;
+#if SSTL_SIMD_SSE2
+    if (end - p >= 8)
+    {
+        __m128i sum0 = _mm_setzero_si128();
+        __m128i sum1 = _mm_setzero_si128();
+        for ( ; end - p >= 8; p += 8)
+        {
+            sum0 = _mm_add_epi32(sum0, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+            sum1 = _mm_add_epi32(sum1, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4)));
+        }
+        unsigned lanes [ 4 ];
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), _mm_add_epi32(sum0, sum1));
+        result = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    }
+#elif SSTL_SIMD_NEON
+    if (end - p >= 4)
+    {
+        uint32x4_t sum = vdupq_n_u32(0);
+        for ( ; end - p >= 4; p += 4)
+            sum = vaddq_u32(sum, vld1q_u32(p));
+        result = vgetq_lane_u32(sum, 0) + vgetq_lane_u32(sum, 1) + vgetq_lane_u32(sum, 2) + vgetq_lane_u32(sum, 3);
+    }
+#endif
+    for ( ; p < end; ++p)
+        result += *p;
+    return result;
+}
+
+// ASCII case folding
+//
+// Only the letters A-Z and a-z change, every other byte including UTF-8 sequences stays as is.
+
+/// Lower case of an ASCII letter, other bytes unchanged
+///
+inline unsigned char _ascii_to_lower(unsigned char c)
+{
+    return static_cast<unsigned char>(c - 'A') < 26 ? static_cast<unsigned char>(c | 0x20) : c;
+}
+
+inline unsigned char _ascii_to_upper(unsigned char c)
+{
+    return static_cast<unsigned char>(c - 'a') < 26 ? static_cast<unsigned char>(c & ~0x20) : c;
+}
+
+#if SSTL_SIMD_SSE2
+
+// Flip the case of the bytes in [first, first + 26)
+inline __m128i _simd_flip_case(__m128i v, char first)
+{
+    // Shift the range to the bottom of signed bytes, so one signed comparison checks both ends
+    const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8(static_cast<char>(-128 - first)));
+    const __m128i in_range = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+    return _mm_xor_si128(v, _mm_and_si128(in_range, _mm_set1_epi8(0x20)));
+}
+
+#elif SSTL_SIMD_NEON
+
+inline uint8x16_t _simd_flip_case(uint8x16_t v, char first)
+{
+    const uint8x16_t in_range = vcltq_u8(vsubq_u8(v, vdupq_n_u8(static_cast<unsigned char>(first))), vdupq_n_u8(26));
+    return veorq_u8(v, vandq_u8(in_range, vdupq_n_u8(0x20)));
+}
+
+#endif
+
+/// Copy bytes converting ASCII letters to lower or upper case, the ranges may be the same
+///
+inline void _simd_ascii_case(char* dst, const char* src, sstl_size_type size, bool upper)
+{
+    const char first = upper ? 'a' : 'A';
+    sstl_size_type i = 0;
+#if SSTL_SIMD_SSE2
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _simd_flip_case(v, first));
+    }
+#elif SSTL_SIMD_NEON
+    for ( ; i + 16 <= size; i += 16)
+        vst1q_u8(reinterpret_cast<unsigned char*>(dst + i), _simd_flip_case(vld1q_u8(reinterpret_cast<const unsigned char*>(src + i)), first));
+#endif
+    for ( ; i < size; ++i)
+    {
+        const unsigned char c = static_cast<unsigned char>(src[i]);
+        dst[i] = static_cast<char>(upper ? _ascii_to_upper(c) : _ascii_to_lower(c));
+    }
+}
+
+/// Compare the bytes as if both ranges were converted to lower case, with the sign of memcmp
+///
+inline int _simd_compare_icase(const char* a, const char* b, sstl_size_type size)
+{
+    sstl_size_type i = 0;
+#if SSTL_SIMD_SSE2
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const __m128i va = _simd_flip_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), 'A');
+        const __m128i vb = _simd_flip_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)), 'A');
+        const unsigned different = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+        if (different != 0)
+        {
+            i += _simd_lowest_bit(different);
+            break;
+        }
+    }
+#elif SSTL_SIMD_NEON
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const uint8x16_t va = _simd_flip_case(vld1q_u8(reinterpret_cast<const unsigned char*>(a + i)), 'A');
+        const uint8x16_t vb = _simd_flip_case(vld1q_u8(reinterpret_cast<const unsigned char*>(b + i)), 'A');
+        const sstl_uint64 different = ~_simd_class_mask_from(vceqq_u8(va, vb));
+        if (different != 0)
+        {
+            i += static_cast<sstl_size_type>(__builtin_ctzll(different)) >> 2;
+            break;
+        }
+    }
+#endif
+    for ( ; i < size; ++i)
+    {
+        const unsigned char ca = _ascii_to_lower(static_cast<unsigned char>(a[i]));
+        const unsigned char cb = _ascii_to_lower(static_cast<unsigned char>(b[i]));
+        if (ca != cb)
+            return ca < cb ? -1 : 1;
+    }
+    return 0;
+}
+
+/// Whether the first range is exactly the second one converted to lower case
+///
+inline bool _simd_equal_lower(const char* lower, const char* s, sstl_size_type size)
+{
+    sstl_size_type i = 0;
+#if SSTL_SIMD_SSE2
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const __m128i vl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + i));
+        const __m128i vs = _simd_flip_case(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), 'A');
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(vl, vs)) != 0xFFFF)
+            return false;
+    }
+#elif SSTL_SIMD_NEON
+    for ( ; i + 16 <= size; i += 16)
+    {
+        const uint8x16_t vl = vld1q_u8(reinterpret_cast<const unsigned char*>(lower + i));
+        const uint8x16_t vs = _simd_flip_case(vld1q_u8(reinterpret_cast<const unsigned char*>(s + i)), 'A');
+        if (~_simd_class_mask_from(vceqq_u8(vl, vs)) != 0)
+            return false;
+    }
+#endif
+    for ( ; i < size; ++i)
+        if (static_cast<unsigned char>(lower[i]) != _ascii_to_lower(static_cast<unsigned char>(s[i])))
+            return false;
+    return true;
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+#include <math.h>
+#include <string.h>
+
+#include <sstl/algorithm>
+#include <sstl/numeric>
+
+using namespace SSTL_NAMESPACE;
+
+// Scalar references, the vectorized algorithms must return exactly the same
+
+template
+    <class T>
+static const T* _reference_find(const T* p, const T* end, T value)
+{
+    while (p != end && !(*p == value))
+        ++p;
+    return p;
+}
+
+template
+    <class T>
+static const T* _reference_min(const T* p, const T* end)
+{
+    const T* result = p;
+    for ( ; p != end; ++p)
+        if (*p < *result)
+            result = p;
+    return result;
+}
+
+template
+    <class T>
+static const T* _reference_max(const T* p, const T* end)
+{
+    const T* result = p;
+    for ( ; p != end; ++p)
+        if (*result < *p)
+            result = p;
+    return result;
+}
+
+static unsigned _random(unsigned& seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+template
+    <class T>
+static void _check_range(const T* a, const T* b, int size)
+{
+    // b is a copy of a with possibly some changed elements
+    const T* end = a + size;
+    for (int i = 0; i < size; i += 7)
+    {
+        ASSERT_EQ(_reference_find(a, end, a[i]), find(a, end, a[i])) << i;
+        ptrdiff_t expected_count = 0;
+        for (int j = 0; j < size; ++j)
+            if (a[j] == a[i])
+                ++expected_count;
+        ASSERT_EQ(expected_count, count(a, end, a[i]));
+    }
+    ASSERT_EQ(_reference_min(a, end), min_element(a, end)) << size;
+    ASSERT_EQ(_reference_max(a, end), max_element(a, end)) << size;
+
+    const T* m = a;
+    while (m != end && *m == b[m - a])
+        ++m;
+    ASSERT_EQ(m, mismatch(a, end, b).first);
+    ASSERT_EQ(b + (m - a), mismatch(a, end, b).second);
+    ASSERT_EQ(m == end, equal(a, end, b));
+}
+
+TEST(algorithm, int_ranges)
+{
+    unsigned seed = 1;
+    for (int size = 0; size < 70; ++size)
+    {
+        int a [ 80 ];
+        int b [ 80 ];
+        for (int i = 0; i < size; ++i)
+            a[i] = static_cast<int>(_random(seed) % 40) - 20; // repeated values and negative ones
+        memcpy(b, a, size * sizeof(a[0]));
+        if (size > 0 && size % 3 == 0)
+            b[_random(seed) % size] += 1;
+        _check_range(a, b, size);
+    }
+}
+
+TEST(algorithm, unsigned_ranges)
+{
+    unsigned seed = 2;
+    for (int size = 0; size < 70; ++size)
+    {
+        unsigned a [ 80 ];
+        unsigned b [ 80 ];
+        for (int i = 0; i < size; ++i)
+            a[i] = (_random(seed) % 2 ? 0x80000000u : 0u) + _random(seed) % 10; // signed comparison would get these wrong
+        memcpy(b, a, size * sizeof(a[0]));
+        if (size > 0 && size % 4 == 0)
+            b[_random(seed) % size] ^= 0x80000000u;
+        _check_range(a, b, size);
+    }
+}
+
+TEST(algorithm, float_ranges)
+{
+    unsigned seed = 3;
+    for (int size = 0; size < 70; ++size)
+    {
+        float a [ 80 ];
+        float b [ 80 ];
+        for (int i = 0; i < size; ++i)
+            a[i] = static_cast<float>(static_cast<int>(_random(seed) % 20) - 10) * 0.5f;
+        if (size > 5 && size % 5 == 0)
+            a[_random(seed) % size] = -0.0f;
+        memcpy(b, a, size * sizeof(a[0]));
+        _check_range(a, b, size);
+        if (size > 0)
+        {
+            a[_random(seed) % size] = NAN; // scalar semantics of comparisons with NaN, never equal to itself
+            memcpy(b, a, size * sizeof(a[0]));
+            _check_range(a, b, size);
+        }
+    }
+}
+
+TEST(algorithm, fill)
+{
+    int a [ 37 ];
+    for (int size = 0; size < 34; ++size)
+    {
+        memset(a, 0, sizeof(a));
+        fill(a + 1, a + 1 + size, -5);
+        for (int i = 0; i < 37; ++i)
+            ASSERT_EQ(i >= 1 && i <= size ? -5 : 0, a[i]);
+    }
+    float f [ 9 ];
+    fill(f, f + 9, 1.5f);
+    ASSERT_EQ(9, count(f, f + 9, 1.5f));
+    char c [ 9 ];
+    fill(c, c + 8, 'x');
+    c[8] = '\0';
+    ASSERT_STREQ("xxxxxxxx", c);
+}
+
+TEST(algorithm, lower_bound)
+{
+    int a [ 40 ];
+    for (int size = 0; size < 40; ++size)
+    {
+        for (int i = 0; i < size; ++i)
+            a[i] = i / 3 * 2; // runs of equal even values
+        for (int value = -1; value <= size; ++value)
+        {
+            const int* expected = a;
+            while (expected != a + size && *expected < value)
+                ++expected;
+            ASSERT_EQ(expected, lower_bound(a, a + size, value)) << size << ' ' << value;
+        }
+    }
+}
+
+TEST(algorithm, accumulate)
+{
+    int a [ 45 ];
+    unsigned u [ 45 ];
+    for (int size = 0; size < 45; ++size)
+    {
+        int expected = 7;
+        unsigned expected_unsigned = 0xFFFFFFF0u;
+        for (int i = 0; i < size; ++i)
+        {
+            a[i] = i * 3 - 50;
+            u[i] = 0x10000000u * static_cast<unsigned>(i); // wraps around
+            expected += a[i];
+            expected_unsigned += u[i];
+        }
+        ASSERT_EQ(expected, accumulate(a, a + size, 7));
+        ASSERT_EQ(expected_unsigned, accumulate(u, u + size, 0xFFFFFFF0u));
+    }
+    const double d [] = {0.5, 0.25};
+    ASSERT_EQ(1.75, accumulate(d, d + 2, 1.0));
+}
@@ -0,0 +1,266 @@
+// Benchmark of character searches
+//
+// Compares string::find and string::rfind with the plain byte loops they used to be,
+// and with memchr and memrchr of the C library, on strings of various lengths
+// with the only match at the far end. Same for string::find_first_of against
+// nested loops and strcspn, and for multi_searcher against one find per keyword.
+//
+
+#if !defined(_GNU_SOURCE)
+    #define _GNU_SOURCE // memrchr
+#endif
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sstl/string>
+#include <sstl/multi_searcher>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/multi_searcher.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+static int _environment_int(const char* name, int default_value)
+{
+    const char* v = getenv(name);
+    return v != NULL && atoi(v) > 0 ? atoi(v) : default_value;
+}
+
+static sstl_uint64 _now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<sstl_uint64>(ts.tv_sec) * 1000000000u + static_cast<sstl_uint64>(ts.tv_nsec);
+}
+
+static const char* _scalar_find(const char* p, const char* end, char c)
+{
+    for ( ; p < end; ++p)
+        if (*p == c)
+            return p;
+    return end;
+}
+
+static const char* _scalar_rfind(const char* begin, const char* end, char c)
+{
+    for (const char* p = end; p != begin; )
+        if (*--p == c)
+            return p;
+    return end;
+}
+
+enum _method
+{
+    method_scalar_find,
+    method_memchr,
+    method_string_find,
+    method_scalar_rfind,
+    method_memrchr,
+    method_string_rfind,
+    method_count
+};
+
+static const char* const method_names [] = {"scalar find", "memchr", "string::find", "scalar rfind", "memrchr", "string::rfind"};
+
+static volatile sstl_size_type s_sink; // keeps the results alive
+
+static sstl_size_type _run(_method method, const string& s, char c)
+{
+    const char* d = s.data();
+    const char* d_end = d + s.size();
+    switch (method)
+    {
+    case method_scalar_find:
+        return static_cast<sstl_size_type>(_scalar_find(d, d_end, c) - d);
+    case method_memchr:
+        return static_cast<sstl_size_type>(static_cast<const char*>(memchr(d, c, s.size())) - d);
+    case method_string_find:
+        return s.find(c);
+    case method_scalar_rfind:
+        return static_cast<sstl_size_type>(_scalar_rfind(d, d_end, c) - d);
+    case method_memrchr:
+        #if defined(__GLIBC__)
+            return static_cast<sstl_size_type>(static_cast<const char*>(memrchr(d, c, s.size())) - d);
+        #else
+            return static_cast<sstl_size_type>(_scalar_rfind(d, d_end, c) - d);
+        #endif
+    case method_string_rfind:
+        return s.rfind(c);
+    default:
+        return 0;
+    }
+}
+
+TEST(bench_find, char)
+{
+    const int milliseconds = _environment_int("SSTL_BENCHMARK_MILLISECONDS", 20);
+    static const sstl_size_type lengths [] = {16, 64, 256, 4096, 65536};
+
+    printf("%-14s", "bytes");
+    for (int m = 0; m < method_count; ++m)
+        printf("%15s", method_names[m]);
+    printf("   (GB/s)\n");
+
+    for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+    {
+        // The match is where each direction finds it last
+        string forward(lengths[l], 'a');
+        forward[lengths[l] - 1] = ',';
+        string backward(lengths[l], 'a');
+        backward[0] = ',';
+
+        printf("%-14u", static_cast<unsigned>(lengths[l]));
+        for (int m = 0; m < method_count; ++m)
+        {
+            const string& s = m < method_scalar_rfind ? forward : backward;
+            const sstl_size_type expected = m < method_scalar_rfind ? lengths[l] - 1 : 0;
+            ASSERT_EQ(expected, _run(static_cast<_method>(m), s, ','));
+
+            const sstl_uint64 deadline = _now() + static_cast<sstl_uint64>(milliseconds) * 1000000u / method_count;
+            const sstl_uint64 started = _now();
+            sstl_uint64 bytes = 0;
+            sstl_uint64 finished;
+            do
+            {
+                for (int i = 0; i < 64; ++i)
+                    s_sink = _run(static_cast<_method>(m), s, ',');
+                bytes += 64 * lengths[l];
+                finished = _now();
+            }
+            while (finished < deadline);
+            printf("%15.2f", static_cast<double>(bytes) / static_cast<double>(finished - started));
+        }
+        printf("\n");
+    }
+}
+
+static const char* _scalar_find_of(const char* p, const char* end, const char* set, sstl_size_type count)
+{
+    for ( ; p < end; ++p)
+        if (memchr(set, *p, count) != NULL)
+            return p;
+    return end;
+}
+
+TEST(bench_find, first_of)
+{
+    const int milliseconds = _environment_int("SSTL_BENCHMARK_MILLISECONDS", 20);
+    static const char* const sets [] = {" \t\r\n", ",;:|=&?#/"};
+    static const sstl_size_type lengths [] = {16, 256, 4096, 65536};
+
+    printf("%-14s%-12s%15s%15s%15s   (GB/s)\n", "bytes", "set", "nested loops", "strcspn", "find_first_of");
+    for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); ++k)
+    {
+        const sstl_size_type count = static_cast<sstl_size_type>(strlen(sets[k]));
+        for (size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); ++l)
+        {
+            string s(lengths[l], 'a');
+            s[lengths[l] - 1] = sets[k][count - 1];
+            const char* c_str = s.c_str();
+            printf("%-14u%-12u", static_cast<unsigned>(lengths[l]), static_cast<unsigned>(count));
+            for (int m = 0; m < 3; ++m)
+            {
+                const sstl_uint64 deadline = _now() + static_cast<sstl_uint64>(milliseconds) * 1000000u / 3;
+                const sstl_uint64 started = _now();
+                sstl_uint64 bytes = 0;
+                sstl_uint64 finished;
+                do
+                {
+                    for (int i = 0; i < 64; ++i)
+                    {
+                        sstl_size_type r;
+                        if (m == 0)
+                            r = static_cast<sstl_size_type>(_scalar_find_of(s.data(), s.data() + s.size(), sets[k], count) - s.data());
+                        else if (m == 1)
+                            r = static_cast<sstl_size_type>(strcspn(c_str, sets[k]));
+                        else
+                            r = s.find_first_of(sets[k], 0, count);
+                        s_sink = r;
+                    }
+                    bytes += 64 * lengths[l];
+                    finished = _now();
+                }
+                while (finished < deadline);
+                ASSERT_EQ(lengths[l] - 1, s_sink);
+                printf("%15.2f", static_cast<double>(bytes) / static_cast<double>(finished - started));
+            }
+            printf("\n");
+        }
+    }
+}
+
+struct _match_counter
+{
+    sstl_size_type count;
+
+    _match_counter() : count(0) {}
+    bool operator()(sstl_size_type, sstl_size_type) {++count; return true;}
+};
+
+TEST(bench_find, keywords)
+{
+    const int milliseconds = _environment_int("SSTL_BENCHMARK_MILLISECONDS", 20);
+    static const int keyword_counts [] = {10, 100, 300};
+    static const sstl_size_type message_size = 4096;
+
+    string message;
+    unsigned seed = 1;
+    while (message.size() < message_size)
+    {
+        seed = seed * 1103515245u + 12345u;
+        message += static_cast<char>('a' + (seed >> 16) % 26);
+        if ((seed >> 8) % 7 == 0)
+            message += ' ';
+    }
+
+    printf("%-14s%15s%15s%12s   (MB/s)\n", "keywords", "find each", "multi_searcher", "states");
+    for (size_t k = 0; k < sizeof(keyword_counts) / sizeof(keyword_counts[0]); ++k)
+    {
+        const int count = keyword_counts[k];
+        string* keywords = new string[count];
+        for (int i = 0; i < count; ++i)
+        {
+            char buffer [ 32 ];
+            sprintf(buffer, "%c%ckey%d", 'a' + i % 26, 'a' + (i / 26) % 26, i);
+            keywords[i] = buffer;
+        }
+        multi_searcher searcher(keywords, static_cast<sstl_size_type>(count));
+
+        double rates [ 2 ];
+        sstl_size_type found [ 2 ];
+        for (int m = 0; m < 2; ++m)
+        {
+            const sstl_uint64 deadline = _now() + static_cast<sstl_uint64>(milliseconds) * 1000000u / 2;
+            const sstl_uint64 started = _now();
+            sstl_uint64 bytes = 0;
+            sstl_uint64 finished;
+            do
+            {
+                sstl_size_type matches = 0;
+                if (m == 0)
+                {
+                    for (int i = 0; i < count; ++i)
+                        for (sstl_size_type pos = message.find(keywords[i]); pos != string::npos; pos = message.find(keywords[i], pos + 1))
+                            ++matches;
+                }
+                else
+                {
+                    _match_counter counter;
+                    searcher.scan(message, counter);
+                    matches = counter.count;
+                }
+                found[m] = matches;
+                bytes += message.size();
+                finished = _now();
+            }
+            while (finished < deadline);
+            rates[m] = static_cast<double>(bytes) * 1000.0 / static_cast<double>(finished - started);
+        }
+        ASSERT_EQ(found[0], found[1]);
+        printf("%-14d%15.1f%15.1f%12u\n", count, rates[0], rates[1], static_cast<unsigned>(searcher.state_count()));
+        delete [] keywords;
+    }
+}
@@ -0,0 +1,199 @@
+// Contention benchmark of string interning and reference counting
+//
+// Runs 1..N threads that concurrently intern strings, copy and destroy shared interned strings,
+// and garbage collect the intern pool, and reports throughput, latency percentiles and scaling efficiency.
+//
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <algorithm>
+
+#include <sstl/string>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+static const int key_count = 256;
+static const int sample_capacity = 1 << 16;
+static const int sample_every = 8; // timing every call would measure mostly the clock
+
+static int _environment_int(const char* name, int default_value)
+{
+    const char* v = getenv(name);
+    return v != NULL && atoi(v) > 0 ? atoi(v) : default_value;
+}
+
+static sstl_uint64 _now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<sstl_uint64>(ts.tv_sec) * 1000000000u + static_cast<sstl_uint64>(ts.tv_nsec);
+}
+
+enum _workload
+{
+    workload_intern_create,
+    workload_copy_destroy,
+    workload_mixed_with_cleanup
+};
+
+static const char* const workload_names [] = {"intern_create", "copy/destroy", "mixed+cleanup"};
+
+struct _shared_state
+{
+    _workload workload;
+    volatile int started;
+    volatile int stopped;
+    char keys [key_count][32];
+    string interned [key_count];
+};
+
+struct _thread_state
+{
+    _shared_state* shared;
+    int id;
+    sstl_uint64 operations;
+    int sample_count;
+    unsigned samples [sample_capacity]; // nanoseconds
+};
+
+static inline void _operation(_shared_state* shared, unsigned i)
+{
+    const unsigned k = i % key_count;
+    switch (shared->workload)
+    {
+    case workload_intern_create:
+        {
+            string s = string::intern_create(shared->keys[k]);
+        }
+        break;
+    case workload_copy_destroy:
+        {
+            string s(shared->interned[k]);
+        }
+        break;
+    case workload_mixed_with_cleanup:
+        if (i % 1024 == 1023)
+            string::intern_cleanup(0);
+        else if ((i & 1) == 0)
+        {
+            string s = string::intern_create(shared->keys[k]);
+        }
+        else
+        {
+            string s(shared->interned[k]);
+        }
+        break;
+    }
+}
+
+static void* _run(void* p)
+{
+    _thread_state* t = static_cast<_thread_state*>(p);
+    _shared_state* shared = t->shared;
+    while (!shared->started)
+        ; // spin so that all threads start together
+    unsigned i = static_cast<unsigned>(t->id) * 7919u;
+    while (!shared->stopped)
+    {
+        for (int j = 0; j < sample_every - 1; ++j)
+            _operation(shared, i++);
+        const sstl_uint64 start = _now();
+        _operation(shared, i++);
+        const unsigned elapsed = static_cast<unsigned>(_now() - start);
+        t->samples[t->sample_count++ % sample_capacity] = elapsed;
+        t->operations += sample_every;
+    }
+    return NULL;
+}
+
+struct _result
+{
+    double operations_per_second;
+    unsigned p50;
+    unsigned p99;
+    unsigned max;
+};
+
+static _result _measure(_shared_state* shared, int thread_count, int milliseconds)
+{
+    _thread_state* threads = new _thread_state [thread_count];
+    pthread_t* handles = new pthread_t [thread_count];
+    shared->started = 0;
+    shared->stopped = 0;
+    for (int i = 0; i < thread_count; ++i)
+    {
+        threads[i].shared = shared;
+        threads[i].id = i;
+        threads[i].operations = 0;
+        threads[i].sample_count = 0;
+        pthread_create(&handles[i], NULL, _run, &threads[i]);
+    }
+
+    const sstl_uint64 start = _now();
+    shared->started = 1;
+    usleep(milliseconds * 1000);
+    shared->stopped = 1;
+    for (int i = 0; i < thread_count; ++i)
+        pthread_join(handles[i], NULL);
+    const sstl_uint64 elapsed = _now() - start;
+
+    sstl_uint64 operations = 0;
+    unsigned* all = new unsigned [sample_capacity * thread_count];
+    int all_count = 0;
+    for (int i = 0; i < thread_count; ++i)
+    {
+        operations += threads[i].operations;
+        const int n = std::min(threads[i].sample_count, sample_capacity);
+        std::copy(threads[i].samples, threads[i].samples + n, all + all_count);
+        all_count += n;
+    }
+    std::sort(all, all + all_count);
+
+    _result r;
+    r.operations_per_second = static_cast<double>(operations) * 1e9 / static_cast<double>(elapsed);
+    r.p50 = all_count != 0 ? all[all_count / 2] : 0;
+    r.p99 = all_count != 0 ? all[(all_count - 1) * 99 / 100] : 0;
+    r.max = all_count != 0 ? all[all_count - 1] : 0;
+
+    delete [] all;
+    delete [] handles;
+    delete [] threads;
+    return r;
+}
+
+TEST(bench_intern, scaling)
+{
+    const int max_threads = _environment_int("SSTL_BENCHMARK_THREADS", 4);
+    const int milliseconds = _environment_int("SSTL_BENCHMARK_MILLISECONDS", 50);
+
+    _shared_state* shared = new _shared_state;
+    for (int k = 0; k < key_count; ++k)
+    {
+        sprintf(shared->keys[k], "device/%d/topic", k);
+        shared->interned[k] = string::intern_create(shared->keys[k]);
+    }
+
+    for (int w = workload_intern_create; w <= workload_mixed_with_cleanup; ++w)
+    {
+        shared->workload = static_cast<_workload>(w);
+        printf("%-14s threads      ops/sec   p50 ns   p99 ns   max ns  efficiency\n", workload_names[w]);
+        double single = 0;
+        for (int threads = 1; threads <= max_threads; ++threads)
+        {
+            _result r = _measure(shared, threads, milliseconds);
+            if (threads == 1)
+                single = r.operations_per_second;
+            const double efficiency = single > 0 ? r.operations_per_second / (single * threads) : 0;
+            printf("%-14s %7d %12.0f %8u %8u %8u %10.0f%%\n", "", threads, r.operations_per_second, r.p50, r.p99, r.max, efficiency * 100);
+            ASSERT_LT(0, r.operations_per_second);
+        }
+    }
+
+    for (int k = 0; k < key_count; ++k)
+        ASSERT_TRUE(shared->interned[k].is_interned());
+    delete shared;
+}
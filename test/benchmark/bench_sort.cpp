@@ -0,0 +1,109 @@
+// Benchmark of string sorting
+//
+// Compares sort_strings with std::sort on operator<, for keys typical for us:
+// random identifiers, URLs with long common prefixes, and few distinct values repeated many times.
+//
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#include <sstl/string>
+#include <sstl/string_sort>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/string_sort.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+static int _environment_int(const char* name, int default_value)
+{
+    const char* v = getenv(name);
+    return v != NULL && atoi(v) > 0 ? atoi(v) : default_value;
+}
+
+static sstl_uint64 _now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<sstl_uint64>(ts.tv_sec) * 1000000000u + static_cast<sstl_uint64>(ts.tv_nsec);
+}
+
+static unsigned _random(unsigned& seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+enum _distribution
+{
+    distribution_identifiers,
+    distribution_urls,
+    distribution_duplicates,
+    distribution_count
+};
+
+static const char* const distribution_names [] = {"identifiers", "urls", "duplicates"};
+
+static void _generate(_distribution d, string* keys, int count)
+{
+    unsigned seed = 11;
+    for (int i = 0; i < count; ++i)
+    {
+        char buffer [ 128 ];
+        switch (d)
+        {
+        case distribution_identifiers:
+            sprintf(buffer, "%c%c%c_%u", 'a' + _random(seed) % 26, 'a' + _random(seed) % 26, 'a' + _random(seed) % 26, _random(seed));
+            break;
+        case distribution_urls:
+            sprintf(buffer, "https://www.example.com/catalog/%s/item/%u", _random(seed) % 2 ? "books" : "music", _random(seed) % 100000);
+            break;
+        default:
+            sprintf(buffer, "status_%u", _random(seed) % 16);
+            break;
+        }
+        keys[i] = buffer;
+    }
+}
+
+TEST(bench_sort, strings)
+{
+    const int milliseconds = _environment_int("SSTL_BENCHMARK_MILLISECONDS", 20);
+    const int count = _environment_int("SSTL_BENCHMARK_STRINGS", 20000);
+
+    string* original = new string[count];
+    string* keys = new string[count];
+    printf("%-14s%15s%15s   (ms per sort of %d)\n", "keys", "std::sort", "sort_strings", count);
+    for (int d = 0; d < distribution_count; ++d)
+    {
+        _generate(static_cast<_distribution>(d), original, count);
+        double times [ 2 ];
+        for (int m = 0; m < 2; ++m)
+        {
+            const sstl_uint64 deadline = _now() + static_cast<sstl_uint64>(milliseconds) * 1000000u / 2;
+            sstl_uint64 spent = 0;
+            int sorts = 0;
+            do
+            {
+                for (int i = 0; i < count; ++i)
+                    keys[i] = original[i];
+                const sstl_uint64 started = _now();
+                if (m == 0)
+                    std::sort(keys, keys + count);
+                else
+                    sort_strings(keys, keys + count);
+                spent += _now() - started;
+                ++sorts;
+            }
+            while (_now() < deadline);
+            for (int i = 1; i < count; ++i)
+                ASSERT_LE(keys[i - 1].compare(keys[i]), 0);
+            times[m] = static_cast<double>(spent) / 1000000.0 / sorts;
+        }
+        printf("%-14s%15.2f%15.2f\n", distribution_names[d], times[0], times[1]);
+    }
+    delete [] keys;
+    delete [] original;
+}
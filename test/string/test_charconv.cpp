@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sstl/charconv>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/charconv.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+TEST(charconv, integers)
+{
+    ASSERT_EQ("0", to_string(0));
+    ASSERT_EQ("-7", to_string(-7));
+    ASSERT_EQ("4294967295", to_string(0xFFFFFFFFu));
+    ASSERT_EQ("-9223372036854775808", to_string(static_cast<sstl_int64>(static_cast<sstl_uint64>(1) << 63)));
+    ASSERT_EQ("18446744073709551615", to_string(~static_cast<sstl_uint64>(0)));
+
+    // Every number of digits and its neighbours
+    sstl_uint64 power = 1;
+    for (unsigned digits = 1; digits <= 20; ++digits, power *= 10)
+    {
+        ASSERT_EQ(digits, _decimal_digits(power));
+        ASSERT_EQ(digits > 1 ? digits - 1 : 1, _decimal_digits(power - 1));
+        char expected[32];
+        snprintf(expected, sizeof(expected), "%llu", static_cast<unsigned long long>(power - 1));
+        ASSERT_EQ(expected, to_string(power - 1));
+    }
+
+    // Appended in place, written into a range
+    string s("id=");
+    append_number(s, 42);
+    s += ',';
+    append_number(s, -100L);
+    ASSERT_EQ("id=42,-100", s);
+
+    char buffer[4];
+    to_chars_result result = to_chars(buffer, buffer + 4, -123);
+    ASSERT_EQ(chars_ok, result.ec);
+    ASSERT_EQ(0, memcmp(buffer, "-123", 4));
+    ASSERT_EQ(buffer + 4, result.ptr);
+    result = to_chars(buffer, buffer + 4, 12345);
+    ASSERT_EQ(chars_value_too_large, result.ec);
+    ASSERT_EQ(buffer + 4, result.ptr);
+}
+
+TEST(charconv, floating_point)
+{
+    // The shorter of the fixed and the scientific notations
+    ASSERT_EQ("0", to_string(0.0));
+    ASSERT_EQ("-0", to_string(-0.0));
+    ASSERT_EQ("1", to_string(1.0));
+    ASSERT_EQ("0.1", to_string(0.1));
+    ASSERT_EQ("0.001", to_string(0.001));
+    ASSERT_EQ("1e-04", to_string(0.0001));
+    ASSERT_EQ("123456", to_string(123456.0));
+    ASSERT_EQ("1234567.125", to_string(1234567.125));
+    ASSERT_EQ("1e+20", to_string(1e20));
+    ASSERT_EQ("16120202535877402624", to_string(16120202535877403000.0)); // exact digits of an integer
+    ASSERT_EQ("-9007199254740994", to_string(-9007199254740994.0));
+    ASSERT_EQ("1152921504606846976", to_string(1152921504606846976.0));
+    ASSERT_EQ("1180591620717411172352", to_string(1180591620717411172352.0)); // (2^53 - 1) * 2^17, beyond 64 bits
+    ASSERT_EQ("5e-324", to_string(5e-324));
+    ASSERT_EQ("1.7976931348623157e+308", to_string(1.7976931348623157e308));
+    ASSERT_EQ("0.1", to_string(0.1f));
+    ASSERT_EQ("3.4028235e+38", to_string(3.4028235e38f));
+    ASSERT_EQ("inf", to_string(1e308 * 10));
+    ASSERT_EQ("-inf", to_string(-1e308 * 10));
+
+    // Every value reads back the same
+    sstl_uint64 state = 1;
+    for (int i = 0; i < 100000; ++i)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double d;
+        memcpy(&d, &state, sizeof(d));
+        if (d != d)
+            continue;
+        char buffer[_max_double_chars];
+        const to_chars_result result = to_chars(buffer, buffer + sizeof(buffer), d);
+        ASSERT_EQ(chars_ok, result.ec);
+        ASSERT_EQ(d, strtod(string(buffer, static_cast<sstl_size_type>(result.ptr - buffer)).c_str(), NULL));
+
+        float f;
+        memcpy(&f, &state, sizeof(f));
+        if (f != f)
+            continue;
+        const string s = to_string(f);
+        ASSERT_EQ(f, strtof(s.c_str(), NULL)) << s.c_str();
+    }
+
+    // A short range gets the characters through a buffer
+    char small[5];
+    to_chars_result result = to_chars(small, small + 5, 2.5);
+    ASSERT_EQ(chars_ok, result.ec);
+    ASSERT_EQ(small + 3, result.ptr);
+    ASSERT_EQ(chars_value_too_large, to_chars(small, small + 5, 3.14159).ec);
+
+    string s("t=");
+    append_number(s, 21.5);
+    ASSERT_EQ("t=21.5", s);
+}
+
+TEST(charconv, parse_integers)
+{
+    // A field of a payload, parsed in place without c_str
+    const string payload("id=-42;count=18446744073709551615;big=18446744073709551616");
+    int id = 0;
+    from_chars_result result = from_chars(payload.data() + 3, payload.data() + payload.size(), id);
+    ASSERT_EQ(chars_ok, result.ec);
+    ASSERT_EQ(-42, id);
+    ASSERT_EQ(';', *result.ptr);
+
+    sstl_uint64 count = 0;
+    result = from_chars(string_view(payload).substr(13, 20), count);
+    ASSERT_EQ(chars_ok, result.ec);
+    ASSERT_EQ(~static_cast<sstl_uint64>(0), count);
+
+    sstl_uint64 big = 7;
+    result = from_chars(string_view(payload).substr(38), big);
+    ASSERT_EQ(chars_result_out_of_range, result.ec);
+    ASSERT_EQ(payload.data() + payload.size(), result.ptr); // all the digits are consumed
+    ASSERT_EQ(7u, big); // and the value is not changed
+
+    // Limits of the narrower types, leading zeros, no sign for unsigned types
+    int i = 0;
+    ASSERT_EQ(chars_ok, from_chars(string("-2147483648"), i).ec);
+    ASSERT_EQ(-2147483647 - 1, i);
+    ASSERT_EQ(chars_result_out_of_range, from_chars(string("2147483648"), i).ec);
+    ASSERT_EQ(chars_ok, from_chars(string("0000000000000000000000000123"), i).ec);
+    ASSERT_EQ(123, i);
+    unsigned u = 5;
+    ASSERT_EQ(chars_invalid_argument, from_chars(string("-1"), u).ec);
+    ASSERT_EQ(chars_invalid_argument, from_chars(string("+1"), u).ec);
+    ASSERT_EQ(chars_invalid_argument, from_chars(string(""), u).ec);
+    ASSERT_EQ(5u, u);
+
+    // Long runs of digits are converted eight at a time, every prefix of one gives the same as strtoull
+    const char* digits = "12345678901234567890";
+    for (sstl_size_type n = 1; n < 20; ++n)
+    {
+        sstl_uint64 v = 0;
+        result = from_chars(digits, digits + n, v);
+        ASSERT_EQ(chars_ok, result.ec);
+        ASSERT_EQ(strtoull(string(digits, n).c_str(), NULL, 10), v);
+    }
+}
+
+TEST(charconv, parse_floating_point)
+{
+    const char* numbers[] =
+    {
+        "0", "-0", "1", "0.1", "21.5", "-273.15", "1e-04", "6.02214076e23", "1.7976931348623157e308",
+        "4.9406564584124654e-324", "2.2250738585072011e-308", "9007199254740993",
+        "9007199254740993.0000000000000000001", "0.30000000000000004441", "123456789012345678901234567890e-10"
+    };
+    for (size_t i = 0; i < sizeof(numbers) / sizeof(numbers[0]); ++i)
+    {
+        const char* s = numbers[i];
+        double d = 0;
+        const from_chars_result result = from_chars(s, s + strlen(s), d);
+        ASSERT_EQ(chars_ok, result.ec) << s;
+        ASSERT_EQ(s + strlen(s), result.ptr) << s;
+        ASSERT_EQ(strtod(s, NULL), d) << s;
+        const float expected = strtof(s, NULL);
+        float f = 0;
+        if (expected - expected != 0 || (expected == 0 && d != 0))
+            ASSERT_EQ(chars_result_out_of_range, from_chars(s, s + strlen(s), f).ec) << s;
+        else
+        {
+            ASSERT_EQ(chars_ok, from_chars(s, s + strlen(s), f).ec) << s;
+            ASSERT_EQ(expected, f) << s;
+        }
+    }
+
+    // Every shortest form reads back the same
+    sstl_uint64 state = 3;
+    for (int i = 0; i < 100000; ++i)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        double d;
+        memcpy(&d, &state, sizeof(d));
+        if (d != d)
+            continue;
+        const string s = to_string(d);
+        double back = 0;
+        ASSERT_EQ(chars_ok, from_chars(s, back).ec) << s.c_str();
+        ASSERT_EQ(0, memcmp(&d, &back, sizeof(d))) << s.c_str();
+    }
+
+    // Where the number ends
+    double d = 5;
+    const string text("1.5e;2e+;.5x;-inf,nan(1)");
+    from_chars_result result = from_chars(text, d);
+    ASSERT_EQ(1.5, d);
+    ASSERT_EQ(text.data() + 3, result.ptr); // e without digits is not a part of the number
+    result = from_chars(string_view(text).substr(5), d);
+    ASSERT_EQ(2, d);
+    ASSERT_EQ(text.data() + 6, result.ptr);
+    result = from_chars(string_view(text).substr(9), d);
+    ASSERT_EQ(0.5, d);
+    result = from_chars(string_view(text).substr(13), d);
+    ASSERT_TRUE(d < 0 && d - d != 0);
+    ASSERT_EQ(text.data() + 17, result.ptr);
+    result = from_chars(string_view(text).substr(18), d);
+    ASSERT_TRUE(d != d);
+    ASSERT_EQ(text.data() + text.size(), result.ptr);
+
+    // Out of range and no number leave the value as is
+    d = 5;
+    ASSERT_EQ(chars_result_out_of_range, from_chars(string("1e400"), d).ec);
+    ASSERT_EQ(chars_result_out_of_range, from_chars(string("-1e-400"), d).ec);
+    ASSERT_EQ(chars_invalid_argument, from_chars(string("."), d).ec);
+    ASSERT_EQ(chars_invalid_argument, from_chars(string("+1"), d).ec);
+    ASSERT_EQ(chars_invalid_argument, from_chars(string(" 1"), d).ec);
+    ASSERT_EQ(5, d);
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <sstl/format>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/string_builder.cpp>
+#include <sstl/_impl/charconv.cpp>
+#include <sstl/_impl/format.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+TEST(format, arguments)
+{
+    const string name("world");
+    ASSERT_EQ("hello, world!", format("hello, {}!", name));
+    ASSERT_EQ("-42 7 18446744073709551615", format("{} {} {}", -42, 7u, static_cast<sstl_uint64>(-1)));
+    ASSERT_EQ("0.5 0.1 1e+20 inf", format("{} {} {} {}", 0.5, 0.1f, 1e20, 1.0 / 0.0));
+    ASSERT_EQ("x true false", format("{} {} {}", 'x', true, false));
+    ASSERT_EQ("view, c string", format("{}, {}", string_view("view!", 4), "c string"));
+    ASSERT_EQ(to_string(-9223372036854775807LL - 1), format("{}", -9223372036854775807LL - 1));
+
+    // Indexes, escapes and braces that are not placeholders
+    ASSERT_EQ("b a a", format("{1} {0} {}", "a", "b")); // {} counts only the {} before it
+    ASSERT_EQ("{a} }", format("{{{}}} }}", "a"));
+    ASSERT_EQ("{x} } {", format("{x} } {", 1));
+    ASSERT_EQ("no arguments", format("no arguments"));
+    ASSERT_TRUE(format("").empty());
+    ASSERT_TRUE(format("{}", "").empty());
+}
+
+TEST(format, exact_size)
+{
+    // The string is written once into a buffer of its exact size
+    const string s = format("{}: {} of {} ({}%)", "progress", 123456, 1000000, 12.3456);
+    ASSERT_EQ("progress: 123456 of 1000000 (12.3456%)", s);
+    ASSERT_LT(s.capacity(), s.size() + 1 + 8);
+
+    // Appended after the existing characters
+    string out("log ");
+    format_to(out, "{}={}", "key", 42);
+    format_to(out, ", {}={}", "pi", 3.25);
+    ASSERT_EQ("log key=42, pi=3.25", out);
+
+    string big;
+    for (int i = 0; i < 1000; ++i)
+        format_to(big, "{},", i);
+    ASSERT_EQ(3890u, big.size());
+    ASSERT_EQ(0, memcmp(big.data() + big.size() - 4, "999,", 4));
+
+    // Appending the string to itself, the buffer is reallocated while the argument refers to it
+    string self("abc");
+    format_to(self, "{}{}", self, string_view(self.data() + 1, 2));
+    ASSERT_EQ("abcabcbc", self);
+    for (int i = 0; i < 10; ++i)
+        format_to(self, "{}", self);
+    ASSERT_EQ(8u << 10, self.size());
+    ASSERT_EQ(0, memcmp(self.data() + self.size() - 8, "abcabcbc", 8));
+
+    // The format string is the string itself
+    string pattern("value {} and {}!");
+    format_to(pattern, string_view(pattern), 12345, 67890);
+    ASSERT_EQ("value {} and {}!value 12345 and 67890!", pattern);
+}
+
+#if SSTL_CXX11
+TEST(format, static_format_string)
+{
+    static_assert(_format_arguments("{} {}", 0, 0) == 2, "");
+    static_assert(_format_arguments("{{}} {3}", 0, 0) == 4, "");
+    static_assert(_format_arguments("{} }", 0, 0) == _format_invalid, "");
+    static_assert(_format_arguments("{x}", 0, 0) == _format_invalid, "");
+
+    ASSERT_EQ("1 + 2 = 3", format(SSTL_FORMAT_STRING("{} + {} = {}"), 1, 2, 3));
+    string s;
+    format_to(s, SSTL_FORMAT_STRING("{{{0}}}"), "checked");
+    ASSERT_EQ("{checked}", s);
+}
+#endif
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <sstl/string>
+#include <sstl/multi_searcher>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/multi_searcher.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+struct _recorder
+{
+    enum {capacity = 64};
+    multi_searcher::size_type patterns [ capacity ];
+    multi_searcher::size_type positions [ capacity ];
+    int count;
+    int stop_after;
+
+    _recorder() : count(0), stop_after(capacity) {}
+
+    bool operator()(multi_searcher::size_type pattern, multi_searcher::size_type position)
+    {
+        patterns[count] = pattern;
+        positions[count] = position;
+        ++count;
+        return count < stop_after;
+    }
+
+    bool has(multi_searcher::size_type pattern, multi_searcher::size_type position) const
+    {
+        for (int i = 0; i < count; ++i)
+            if (patterns[i] == pattern && positions[i] == position)
+                return true;
+        return false;
+    }
+};
+
+TEST(test_multi_searcher, classic)
+{
+    const string patterns [] = {"he", "she", "his", "hers"};
+    multi_searcher searcher(patterns, 4);
+    ASSERT_EQ(4, searcher.pattern_count());
+
+    _recorder r;
+    ASSERT_TRUE(searcher.scan(string("ushers"), r));
+    ASSERT_EQ(3, r.count);
+    ASSERT_TRUE(r.has(1, 1)); // she
+    ASSERT_TRUE(r.has(0, 2)); // he
+    ASSERT_TRUE(r.has(3, 2)); // hers
+    ASSERT_EQ(3, r.patterns[2]); // reported in the order of the last byte
+
+    ASSERT_TRUE(searcher.contains_any(string("a history")));
+    ASSERT_FALSE(searcher.contains_any(string("nothing to see")));
+    ASSERT_EQ(0, searcher.count(string("")));
+    ASSERT_EQ(4, searcher.count(string("hehehe his")));
+}
+
+TEST(test_multi_searcher, duplicates_empty_and_stop)
+{
+    const string patterns [] = {"ab", "", "ab", "b", string("\xff\x00", 2)};
+    multi_searcher searcher(patterns, 5);
+
+    _recorder r;
+    ASSERT_TRUE(searcher.scan(string("xab\xff\x00y", 6), r));
+    ASSERT_EQ(4, r.count);
+    ASSERT_TRUE(r.has(0, 1));
+    ASSERT_TRUE(r.has(2, 1));
+    ASSERT_TRUE(r.has(3, 2));
+    ASSERT_TRUE(r.has(4, 3));
+
+    _recorder first;
+    first.stop_after = 1;
+    ASSERT_FALSE(searcher.scan(string("abab"), first));
+    ASSERT_EQ(1, first.count);
+
+    multi_searcher empty;
+    ASSERT_FALSE(empty.contains_any(string("abc")));
+    empty.compile(patterns, 0);
+    ASSERT_FALSE(empty.contains_any(string("abc")));
+}
+
+TEST(test_multi_searcher, stream)
+{
+    const string patterns [] = {"topic/alarm", "alarm", "/a"};
+    multi_searcher searcher(patterns, 3);
+    const string text("xx/topic/alarm/topic/alarmyy");
+
+    for (string::size_type chunk = 1; chunk < 8; ++chunk)
+    {
+        _recorder whole;
+        searcher.scan(text, whole);
+
+        _recorder parts;
+        multi_searcher::stream_state state;
+        for (string::size_type i = 0; i < text.size(); i += chunk)
+        {
+            const string::size_type n = text.size() - i < chunk ? text.size() - i : chunk;
+            searcher.scan(state, text.data() + i, n, parts);
+        }
+        ASSERT_EQ(whole.count, parts.count);
+        for (int i = 0; i < whole.count; ++i)
+        {
+            ASSERT_EQ(whole.patterns[i], parts.patterns[i]);
+            ASSERT_EQ(whole.positions[i], parts.positions[i]);
+        }
+    }
+}
+
+TEST(test_multi_searcher, same_as_find)
+{
+    // Compare with one find per pattern on repetitive text over a small alphabet
+    string patterns [ 20 ];
+    unsigned seed = 12345;
+    for (int p = 0; p < 20; ++p)
+    {
+        const int size = 1 + p % 5;
+        for (int i = 0; i < size; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            patterns[p] += static_cast<char>('a' + (seed >> 16) % 3);
+        }
+    }
+    string text;
+    for (int i = 0; i < 300; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        text += static_cast<char>('a' + (seed >> 16) % 3);
+    }
+
+    multi_searcher searcher(patterns, 20);
+    string::size_type expected = 0;
+    for (int p = 0; p < 20; ++p)
+        for (string::size_type pos = text.find(patterns[p]); pos != string::npos; pos = text.find(patterns[p], pos + 1))
+            ++expected;
+    ASSERT_EQ(expected, searcher.count(text));
+}
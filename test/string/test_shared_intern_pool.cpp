@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+
+#include <sstl/string>
+#include <sstl/shared_intern_pool>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/shared_intern_pool.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+static void _make_segment_name(char* name, const char* test)
+{
+    sprintf(name, "/sstl_test_%s_%d", test, static_cast<int>(getpid()));
+}
+
+TEST(test_shared_intern_pool, create_and_intern)
+{
+    char name[64];
+    _make_segment_name(name, "create");
+    shared_intern_pool::remove(name);
+
+    shared_intern_pool pool;
+    ASSERT_TRUE(pool.create(name, 64, 4096));
+    ASSERT_TRUE(pool.is_open());
+
+    {
+        string a = pool.intern_create("device/sensor/0");
+        string b = pool.intern_create(string("device/sensor/0"));
+        string c = pool.intern_create("device/sensor/1");
+        ASSERT_EQ(a.data(), b.data()); // one copy in the segment
+        ASSERT_NE(a.data(), c.data());
+        ASSERT_EQ(2, pool.size());
+        ASSERT_TRUE(pool.contains(a));
+        ASSERT_TRUE(strcmp(a.c_str(), "device/sensor/0") == 0);
+        ASSERT_EQ(a.data(), a.c_str()); // no reallocation for the terminator
+
+        // Modification makes a private copy
+        string d = a;
+        d += "/x";
+        ASSERT_FALSE(pool.contains(d));
+        ASSERT_TRUE(a == "device/sensor/0");
+
+        // Interning in the private pool does not touch the segment
+        string e = a;
+        e.intern();
+        ASSERT_TRUE(e.is_interned());
+        ASSERT_FALSE(a.is_interned());
+        ASSERT_FALSE(pool.contains(e));
+        ASSERT_TRUE(e == a);
+
+        const shared_intern_pool::size_type offset = pool.offset_of(c);
+        ASSERT_NE(shared_intern_pool::npos, offset);
+        ASSERT_EQ(c.data(), pool.from_offset(offset).data());
+        ASSERT_EQ(0, pool.offset_of(string()));
+        ASSERT_TRUE(pool.from_offset(0).empty());
+        ASSERT_EQ(shared_intern_pool::npos, pool.offset_of(string("private")));
+    }
+
+    pool.close();
+    ASSERT_TRUE(shared_intern_pool::remove(name));
+}
+
+TEST(test_shared_intern_pool, full_falls_back_to_private_pool)
+{
+    char name[64];
+    _make_segment_name(name, "full");
+    shared_intern_pool::remove(name);
+
+    shared_intern_pool pool;
+    ASSERT_TRUE(pool.create(name, 4, 4096)); // fits two strings
+    {
+        string a = pool.intern_create("a");
+        string b = pool.intern_create("b");
+        string c = pool.intern_create("c");
+        ASSERT_TRUE(pool.contains(a));
+        ASSERT_TRUE(pool.contains(b));
+        ASSERT_FALSE(pool.contains(c));
+        ASSERT_TRUE(c.is_interned());
+        ASSERT_TRUE(c == "c");
+    }
+    pool.close();
+    shared_intern_pool::remove(name);
+}
+
+TEST(test_shared_intern_pool, two_processes)
+{
+    char name[64];
+    _make_segment_name(name, "processes");
+    shared_intern_pool::remove(name);
+
+    shared_intern_pool pool;
+    ASSERT_TRUE(pool.create(name, 256, 16384));
+    string mine = pool.intern_create("topic/common");
+
+    int pipe_fds[2];
+    ASSERT_EQ(0, pipe(pipe_fds));
+    const pid_t child = fork();
+    ASSERT_NE(-1, child);
+    if (child == 0)
+    {
+        // Another process with its own mapping of the segment
+        shared_intern_pool other;
+        int status = 1;
+        if (other.open(name))
+        {
+            string common = other.intern_create("topic/common");
+            string added = other.intern_create("topic/from_child");
+            if (other.offset_of(common) == pool.offset_of(mine))
+            {
+                const shared_intern_pool::size_type offset = other.offset_of(added);
+                if (write(pipe_fds[1], &offset, sizeof(offset)) == static_cast<ssize_t>(sizeof(offset)))
+                    status = 0;
+            }
+        }
+        _exit(status);
+    }
+
+    shared_intern_pool::size_type offset = 0;
+    ASSERT_EQ(static_cast<ssize_t>(sizeof(offset)), read(pipe_fds[0], &offset, sizeof(offset)));
+    int status = 0;
+    ASSERT_EQ(child, waitpid(child, &status, 0));
+    ASSERT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    string received = pool.from_offset(offset); // no copying
+    ASSERT_TRUE(received == "topic/from_child");
+    ASSERT_EQ(received.data(), pool.intern_create("topic/from_child").data());
+    ASSERT_EQ(2, pool.size());
+
+    mine.clear();
+    received.clear();
+    pool.close();
+    shared_intern_pool::remove(name);
+}
+
+TEST(test_shared_intern_pool, corrupted_segment)
+{
+    char name[64];
+    _make_segment_name(name, "corrupted");
+    shared_intern_pool::remove(name);
+
+    shared_intern_pool pool;
+    ASSERT_TRUE(pool.create(name, 16, 4096));
+    const int fd = shm_open(name, O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    struct stat st;
+    ASSERT_EQ(0, fstat(fd, &st));
+    ASSERT_EQ(0u, st.st_mode & 077u); // owner only by default
+    _shared_intern_header* header = static_cast<_shared_intern_header*>(mmap(NULL, static_cast<size_t>(st.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    close(fd);
+    ASSERT_TRUE(header != MAP_FAILED);
+
+    {
+        const string a = pool.intern_create("abc");
+        const shared_intern_pool::size_type offset = pool.offset_of(a);
+        ASSERT_EQ(a.data(), pool.from_offset(offset).data());
+
+        // Offsets outside the heap or not at a buffer are refused in release builds
+#ifdef NDEBUG
+        ASSERT_TRUE(pool.from_offset(offset + 4).empty());
+        ASSERT_TRUE(pool.from_offset(8).empty());
+        ASSERT_TRUE(pool.from_offset(0x7FFFFFF0).empty());
+#endif
+
+        // A cell pointing outside the segment is skipped
+        for (unsigned i = 0; i < header->table_capacity; ++i)
+            if (header->cells()[i].offset == static_cast<int>(offset))
+                header->cells()[i].offset = 0x7FFFFFF0;
+        const string b = pool.intern_create("abc");
+        ASSERT_TRUE(b == "abc");
+        ASSERT_NE(a.data(), b.data());
+    }
+
+    // A header with the heap beyond the segment is not opened
+    header->heap_end = 0x7FFFFFF0;
+    shared_intern_pool other;
+    ASSERT_FALSE(other.open(name));
+
+    munmap(header, static_cast<size_t>(st.st_size));
+    pool.close();
+    shared_intern_pool::remove(name);
+}
+
+TEST(test_shared_intern_pool, unrecoverable_lock)
+{
+    char name[64];
+    _make_segment_name(name, "unrecoverable");
+    shared_intern_pool::remove(name);
+
+    shared_intern_pool pool;
+    ASSERT_TRUE(pool.create(name, 16, 4096));
+    const int fd = shm_open(name, O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    _shared_intern_header* header = static_cast<_shared_intern_header*>(mmap(NULL, sizeof(_shared_intern_header), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+    close(fd);
+    ASSERT_TRUE(header != MAP_FAILED);
+
+    // A child dies holding the lock, and the next owner unlocks it without making it consistent
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        pthread_mutex_lock(&header->lock);
+        _exit(0);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_EQ(EOWNERDEAD, pthread_mutex_lock(&header->lock));
+    pthread_mutex_unlock(&header->lock);
+
+    {
+        string s = pool.intern_create("after the lock is lost");
+        ASSERT_FALSE(pool.contains(s));
+        ASSERT_TRUE(s.is_interned());
+    }
+    munmap(header, sizeof(_shared_intern_header));
+    pool.close();
+    shared_intern_pool::remove(name);
+}
+
+TEST(test_shared_intern_pool, open_missing)
+{
+    shared_intern_pool pool;
+    ASSERT_FALSE(pool.open("/sstl_test_missing_segment"));
+    ASSERT_FALSE(pool.is_open());
+}
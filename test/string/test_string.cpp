@@ -10,6 +10,7 @@
     #include <sstl/string>
     #include <sstl/iterator>
     #include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
 
     using namespace SSTL_NAMESPACE;
 #endif
@@ -283,6 +284,42 @@ TEST(test_string, c_str_data)
         ASSERT_TRUE(memcmp(s.data() + i, "0123456789", 10) == 0);
 }
 
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, append_insert_self)
+{
+    // The source is a part of the string, which reallocates or moves its characters meanwhile
+    string s("0123456789abcdef");
+    s.append(string_view(s).substr(4, 8));
+    ASSERT_EQ("0123456789abcdef456789ab", s);
+    s.reserve(100);
+    s.append(s.data() + 10, 6); // in place
+    ASSERT_EQ("0123456789abcdef456789ababcdef", s);
+
+    string t("abcdef");
+    t.insert(0, string_view(t));
+    ASSERT_EQ("abcdefabcdef", t);
+    t.reserve(100);
+    t.insert(2, string_view(t).substr(0, 4)); // in place, the source is moved by the insertion
+    ASSERT_EQ("ababcdcdefabcdef", t);
+    t.insert(3, t);
+    ASSERT_EQ("abaababcdcdefabcdefbcdcdefabcdef", t);
+}
+
+TEST(test_string, replace_self)
+{
+    string s("abcdef");
+    s.replace(0, 1, string_view(s));
+    ASSERT_EQ("abcdefbcdef", s);
+    s.reserve(100);
+    s.replace(1, 2, string_view(s).substr(6, 5)); // in place, the source is in the moved tail
+    ASSERT_EQ("abcdefdefbcdef", s);
+    s.replace(0, 3, s);
+    ASSERT_EQ("abcdefdefbcdefdefdefbcdef", s);
+    s.replace(0, 10, s.data() + 17, 5); // shrinks in place
+    ASSERT_EQ("defbccdefdefdefbcdef", s);
+}
+#endif
+
 TEST(test_string, reserve_resize)
 {
     string s1 = "abc";
@@ -589,6 +626,33 @@ TEST(test_string, rfind_char)
     _check_rfind(s0, '\0', string::npos, 7);
 }
 
+TEST(test_string, find_rfind_char_long) // vector and tail paths of all lengths
+{
+    const string::size_type npos = string::npos;
+    for (string::size_type len = 0; len < 100; ++len)
+    {
+        const string s(len, '.');
+        for (string::size_type i = 0; i < len; ++i)
+        {
+            string t(s);
+            t[i] = '#';
+            for (string::size_type pos = 0; pos <= len; pos += 7)
+            {
+                ASSERT_EQ(pos <= i ? i : npos, t.find('#', pos));
+                ASSERT_EQ(pos >= i ? i : npos, t.rfind('#', pos));
+            }
+            ASSERT_EQ(i, t.rfind('#'));
+        }
+        ASSERT_EQ(npos, s.find('#'));
+        ASSERT_EQ(npos, s.rfind('#'));
+        if (len != 0)
+        {
+            ASSERT_EQ(0, s.find('.'));
+            ASSERT_EQ(len - 1, s.rfind('.'));
+        }
+    }
+}
+
 static void _check_rfind(const string& s, const string& p, string::size_type pos, string::size_type expected)
 {
     string::size_type result = s.rfind(p, pos);
@@ -642,6 +706,37 @@ TEST(test_string, rfind_str)
     _check_rfind(s, sp, string::npos, 6);
 }
 
+TEST(test_string, find_rfind_str_long) // short and long patterns, periodic text
+{
+    const string::size_type npos = string::npos;
+    string text(1000, 'a');
+    text[500] = 'b';
+    for (string::size_type m = 2; m < 100; m += 7)
+    {
+        string pattern(m, 'a');
+        pattern[m / 2] = 'b';
+        ASSERT_EQ(500 - m / 2, text.find(pattern));
+        ASSERT_EQ(500 - m / 2, text.rfind(pattern));
+        pattern[m / 2] = 'c';
+        ASSERT_EQ(npos, text.find(pattern));
+        ASSERT_EQ(npos, text.rfind(pattern));
+
+        const string all_a(m, 'a');
+        ASSERT_EQ(0, text.find(all_a));
+        ASSERT_EQ(1000 - m, text.rfind(all_a));
+        ASSERT_EQ(501, text.find(all_a, 500 - m + 1));
+    }
+
+    string periodic;
+    for (int i = 0; i < 50; ++i)
+        periodic += "abcab";
+    const string pattern = periodic.substr(0, 60) + "x";
+    ASSERT_EQ(npos, periodic.find(pattern));
+    periodic += "x";
+    ASSERT_EQ(periodic.size() - 61, periodic.find(pattern));
+    ASSERT_EQ(periodic.size() - 61, periodic.rfind(pattern));
+}
+
 static void _check_substr(const string& s, string::size_type pos, string::size_type count, const string& result)
 {
     string ret1 = s.substr(pos, count);
@@ -655,6 +750,51 @@ static void _check_substr(const string& s, string::size_type pos, string::size_t
     ASSERT_EQ(ret3, s);
 }
 
+static string::size_type _naive_find_of(const string& s, const string& set, string::size_type pos, bool forward, bool negate)
+{
+    const string::size_type npos = string::npos;
+    if (s.empty())
+        return npos;
+    string::size_type i = forward ? pos : (pos < s.size() ? pos : s.size() - 1);
+    for ( ; i < s.size(); forward ? ++i : --i) // decrementing past zero wraps around to a huge value
+        if ((memchr(set.data(), s[i], set.size()) != NULL) != negate)
+            return i;
+    return npos;
+}
+
+TEST(test_string, find_of_family)
+{
+    static const char* const sets [] = {" ", " \t\r\n", ",;:|", "0123456789", "\x80\xff", "\x01\x11\x21\x31\x41\x51\x61\x71\x81\x91", ""};
+    const string alphabet("ab \t,;0123456789:|\x80\xff\x01\x11\x21\x31\x41\x51\x61\x71\x81\x91", 30);
+    for (size_t k = 0; k < sizeof(sets) / sizeof(sets[0]); ++k)
+    {
+        const string set(sets[k], strlen(sets[k]));
+        for (string::size_type len = 0; len < 70; len += 3)
+        {
+            string s;
+            for (string::size_type i = 0; i < len; ++i)
+                s += (i * 7 + len) % 5 == 0 ? alphabet[(i * 13 + k) % alphabet.size()] : 'x';
+            for (string::size_type pos = 0; pos <= len + 1; pos += 5)
+            {
+                ASSERT_EQ(_naive_find_of(s, set, pos, true, false), s.find_first_of(set, pos));
+                ASSERT_EQ(_naive_find_of(s, set, pos, false, false), s.find_last_of(set, pos));
+                ASSERT_EQ(_naive_find_of(s, set, pos, true, true), s.find_first_not_of(set, pos));
+                ASSERT_EQ(_naive_find_of(s, set, pos, false, true), s.find_last_not_of(set, pos));
+            }
+            ASSERT_EQ(_naive_find_of(s, set, string::npos, false, false), s.find_last_of(set));
+            ASSERT_EQ(_naive_find_of(s, set, string::npos, false, true), s.find_last_not_of(set));
+        }
+    }
+
+    const string line("  key = value ; other\t");
+    ASSERT_EQ(2, line.find_first_not_of(" \t"));
+    ASSERT_EQ(20, line.find_last_not_of(" \t"));
+    ASSERT_EQ(6, line.find_first_of("=;"));
+    ASSERT_EQ(14, line.find_last_of("=;"));
+    ASSERT_EQ(1, line.find_last_of(' ', 1));
+    ASSERT_EQ(2, line.find_first_not_of(' ', 2));
+}
+
 TEST(test_string, substr)
 {
     _check_substr("", 0, 0, "");
@@ -1050,6 +1190,65 @@ TEST(test_string, operator_plus)
     ASSERT_EQ(s1, "abcdefghijklmnopqABCDEFGHIJKLMNOPQ0123456789");
 }
 
+#if defined(_SSTL__STRING_INCLUDED)
+
+TEST(test_string, operator_plus_lazy)
+{
+    const string header("Content-Length");
+    const string value("1024");
+
+    // One buffer of the exact size
+    string line = header + ": " + value + "\r\n";
+    ASSERT_EQ(line, "Content-Length: 1024\r\n");
+    ASSERT_EQ(22u, (header + ": " + value + "\r\n").size());
+    ASSERT_GE(line.capacity(), line.size() + 1);
+    ASSERT_LT(line.capacity(), line.size() + 1 + 8);
+    const char* c = line.c_str();
+    ASSERT_EQ(c, line.data()); // no reallocation for the zero
+
+    // Parentheses, views and characters
+    line = header + (": " + value) + string_view("\r\n;", 2);
+    ASSERT_EQ(line, "Content-Length: 1024\r\n");
+    line = string_view("[") + header + ']';
+    ASSERT_EQ(line, "[Content-Length]");
+    ASSERT_EQ("[Content-Length]", (string_view("[") + header + ']').str());
+
+    // The expression compares as its string, other methods of string are called through str()
+    ASSERT_TRUE(header + ": " + value == "Content-Length: 1024");
+    ASSERT_TRUE("Content-Length1024" == header + value);
+    ASSERT_TRUE(header + value == string("Content-Length1024"));
+    ASSERT_TRUE(header + value == string_view("Content-Length1024"));
+    ASSERT_TRUE(header + value != header + ": " + value);
+    ASSERT_TRUE(value + header < header + value);
+    ASSERT_TRUE(header + value >= header);
+    ASSERT_FALSE(header + value <= header);
+    ASSERT_TRUE(header > "" + value);
+    ASSERT_EQ(0, strcmp((header + value).str().c_str(), "Content-Length1024"));
+
+    // Appending writes the parts in place, even the parts that are the string itself
+    string s("ab");
+    s.reserve(64);
+    const char* before = s.data();
+    s += s + "-" + s;
+    ASSERT_EQ(s, "abab-ab");
+    ASSERT_EQ(before, s.data());
+    s.append(s + s + s + s + s + s + s + s + s + s);
+    ASSERT_EQ(77u, s.size());
+    ASSERT_EQ(0, memcmp(s.data(), "abab-ababab-ab", 14));
+
+    // Shared strings are not changed
+    string shared(s);
+    shared += "x" + value;
+    ASSERT_EQ(77u, s.size());
+    ASSERT_EQ(82u, shared.size());
+
+    string empty;
+    empty += empty + "";
+    ASSERT_TRUE(empty.empty());
+}
+
+#endif
+
 TEST(test_string, operator_plus_equal)
 {
     string s1;
@@ -1072,3 +1271,303 @@ TEST(test_string, sizeofs)
 {
     printf("  sizeof(string) = %d\n", static_cast<int>(sizeof(string)));
 }
+
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, intern_merge)
+{
+    string existing = string::intern_create("interned before merge");
+
+    intern_staging stagings [2];
+    char buff [32];
+    for (int i = 0; i < 3000; ++i) // enough to grow both staging tables and the pool
+    {
+        sprintf(buff, "staged %d", i);
+        ASSERT_EQ(static_cast<string::size_type>(i), stagings[0].add(buff));
+        sprintf(buff, "staged %d", i + 1000); // overlaps with the other table
+        stagings[1].add(buff);
+    }
+    ASSERT_EQ(0u, stagings[0].add("staged 0")); // duplicates are found
+    ASSERT_EQ(3000u, stagings[0].add(string("interned before merge")));
+    ASSERT_EQ(3001u, stagings[0].size());
+    ASSERT_EQ(3000u, stagings[1].size());
+    ASSERT_FALSE(stagings[0].is_merged());
+    ASSERT_EQ(3000u, stagings[1].add("")); // the empty string buffer, not a copy of it
+
+    string::intern_merge(stagings, 2);
+    ASSERT_TRUE(stagings[0].is_merged());
+    ASSERT_TRUE(stagings[1].is_merged());
+
+    ASSERT_EQ(existing.data(), stagings[0][3000].data());
+    string s = stagings[0][1500];
+    ASSERT_TRUE(s.is_interned());
+    ASSERT_EQ(s, "staged 1500");
+    ASSERT_EQ(s.data(), stagings[1][500].data()); // the same buffer from both tables
+    ASSERT_EQ(s.data(), string::intern_create("staged 1500").data());
+    ASSERT_EQ(string::intern_create("staged 3999").data(), stagings[1][2999].data());
+    ASSERT_EQ(string().data(), stagings[1][3000].data());
+    ASSERT_EQ(string::intern_create("").data(), stagings[1][3000].data());
+
+    stagings[0].clear();
+    ASSERT_EQ(0u, stagings[0].size());
+    ASSERT_EQ(0u, stagings[0].add("reused"));
+    string::intern_cleanup(0);
+    ASSERT_EQ(s.data(), string::intern_create("staged 1500").data());
+}
+#endif
+
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, interned_identity)
+{
+    string a = string::intern_create("identity key");
+    string b("identity key");
+    string shared = b; // another owner of the buffer being interned
+    b.intern();
+    ASSERT_EQ(a.data(), b.data());
+    ASSERT_FALSE(shared.is_interned()); // left as a plain copy, not a second interned buffer
+    ASSERT_TRUE(shared == a);
+    ASSERT_EQ(string::static_hash("identity key", 12), a.hash());
+    ASSERT_EQ(shared.hash(), a.hash());
+
+    string c = string::intern_create("identity kez");
+    ASSERT_FALSE(a == c);
+    ASSERT_TRUE(a != c);
+
+    interned_less less;
+    interned_equal_to equal_to;
+    interned_hash hash;
+    ASSERT_TRUE(less(a, c) != less(c, a));
+    ASSERT_FALSE(less(a, b));
+    ASSERT_TRUE(equal_to(a, b));
+    ASSERT_FALSE(equal_to(a, c));
+    ASSERT_EQ(a.hash(), hash(b));
+}
+#endif
+
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, hash_memoized)
+{
+    string s("message key");
+    const unsigned h = string::static_hash("message key", 11);
+    ASSERT_EQ(h, s.hash());
+    ASSERT_EQ(h, s.hash()); // remembered
+    ASSERT_FALSE(s.is_interned());
+    ASSERT_EQ(h, string(s).hash()); // copies share the remembered value
+
+    // Every change in place forgets it
+    s[0] = 'M';
+    ASSERT_EQ(string::static_hash("Message key", 11), s.hash());
+    s += "s";
+    ASSERT_EQ(string::static_hash("Message keys", 12), s.hash());
+    s.pop_back();
+    ASSERT_EQ(string::static_hash("Message key", 11), s.hash());
+    s.erase(0, 1);
+    ASSERT_EQ(string::static_hash("essage key", 10), s.hash());
+    s.insert(0, "m");
+    ASSERT_EQ(h, s.hash());
+    s.resize(7);
+    ASSERT_EQ(string::static_hash("message", 7), s.hash());
+    s.assign("other");
+    ASSERT_EQ(string::static_hash("other", 5), s.hash());
+    s.back() = 'R';
+    ASSERT_EQ(string::static_hash("otheR", 5), s.hash());
+    s.clear();
+    ASSERT_EQ(string::static_hash("", 0), s.hash());
+
+    // A memoized hash does not make a string interned, and interning keeps the capacity
+    string k("memoized then interned");
+    const string::size_type capacity = k.capacity();
+    k.hash();
+    k.intern();
+    ASSERT_TRUE(k.is_interned());
+    ASSERT_EQ(capacity, k.capacity());
+    ASSERT_EQ(string::static_hash("memoized then interned", 22), k.hash());
+    ASSERT_EQ(k.data(), string::intern_create("memoized then interned").data());
+}
+#endif
+
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, case_folding)
+{
+    string s("Content-Type: Text/HTML; charset=UTF-8 \xC3\x84 [@`{~]");
+    string copy = s;
+    s.to_lower();
+    ASSERT_EQ(s, "content-type: text/html; charset=utf-8 \xC3\x84 [@`{~]"); // only ASCII letters change
+    ASSERT_EQ(copy, "Content-Type: Text/HTML; charset=UTF-8 \xC3\x84 [@`{~]"); // unshared before the change
+    s.to_upper();
+    ASSERT_EQ(s, "CONTENT-TYPE: TEXT/HTML; CHARSET=UTF-8 \xC3\x84 [@`{~]");
+
+    ASSERT_EQ(0, s.compare_icase(copy));
+    ASSERT_EQ(0, string("ABC").compare_icase("abc"));
+    ASSERT_GT(0, string("abc").compare_icase("ABCD"));
+    ASSERT_LT(0, string("abd").compare_icase("ABC"));
+    ASSERT_GT(0, string("a_").compare_icase("Ab")); // '_' compares below 'b', not above 'B'
+    string long_a(40, 'x');
+    string long_b(40, 'X');
+    long_b[33] = 'Y';
+    ASSERT_GT(0, long_a.compare_icase(long_b));
+
+    ASSERT_EQ(string::static_hash("content-type", 12), string::static_hash_icase("Content-TYPE", 12));
+
+    string h1 = string::intern_create_icase("X-Forwarded-For-Some-Long-Header");
+    string h2 = string::intern_create_icase("x-forwarded-for-some-long-header");
+    string mixed = string::intern_create("X-Forwarded-For-Some-Long-Header"); // exact spelling, a different item
+    ASSERT_EQ(h1, "x-forwarded-for-some-long-header");
+    ASSERT_EQ(h1.data(), h2.data());
+    ASSERT_NE(h1.data(), mixed.data());
+    ASSERT_EQ(h1.data(), string::intern_create("x-forwarded-for-some-long-header").data());
+    ASSERT_EQ(h1.data(), string::intern_create_icase("X-FORWARDED-FOR-SOME-LONG-HEADER").data());
+}
+#endif
+
+#if defined(_SSTL__STRING_INCLUDED)
+struct _fill_digits
+{
+    string::size_type operator()(char* p, string::size_type count) const
+    {
+        for (string::size_type i = 0; i < count; ++i)
+            p[i] = static_cast<char>('0' + i % 10);
+        return count / 2; // keep a half
+    }
+};
+
+TEST(test_string, resize_and_overwrite)
+{
+    string s("abc");
+    s.resize_and_overwrite(20, _fill_digits());
+    ASSERT_EQ(s, "0123456789");
+
+    // Shrinking a shared string copies only the kept part and does not change the other owner
+    string shared(s);
+    shared.resize_and_overwrite(4, _fill_digits());
+    ASSERT_EQ(shared, "01");
+    ASSERT_EQ(s, "0123456789");
+    ASSERT_FALSE(s.is_shared());
+
+    // Shrinking by resize, shared or not
+    string other(s);
+    other.resize(3);
+    ASSERT_EQ(other, "012");
+    ASSERT_EQ(s, "0123456789");
+    s.resize(12);
+    ASSERT_EQ(12u, s.size());
+    ASSERT_EQ(0, memcmp(s.data(), "0123456789\0\0", 12));
+    s.resize(0);
+    ASSERT_TRUE(s.empty());
+
+    // The hash of the old contents is forgotten
+    string h("hashed");
+    const unsigned before = h.hash();
+    h.resize_and_overwrite(6, _fill_digits());
+    ASSERT_EQ(h, "012");
+    ASSERT_NE(before, h.hash());
+    ASSERT_EQ(string::static_hash("012", 3), h.hash());
+
+    string tail("key=");
+    char* p = tail.append_uninitialized(5);
+    memcpy(p, "value", 5);
+    ASSERT_EQ(tail, "key=value");
+}
+#endif
+
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, apply_edits)
+{
+    static const char* const texts [] = {"", "x", "yz", "0123456789abcdef"};
+    unsigned seed = 7;
+    for (int round = 0; round < 2000; ++round)
+    {
+        seed = seed * 1103515245u + 12345u;
+        string original(static_cast<string::size_type>((seed >> 8) % 60), 'a');
+        for (string::size_type i = 0; i < original.size(); ++i)
+            original[i] = static_cast<char>('A' + i % 26);
+
+        // Random sorted edits, and the same applied by replace from the back
+        string_edit edits [ 8 ];
+        string::size_type count = 0;
+        string::size_type pos = 0;
+        while (count < 8)
+        {
+            seed = seed * 1103515245u + 12345u;
+            pos += (seed >> 8) % 7;
+            if (pos > original.size())
+                break;
+            const string::size_type n = (seed >> 12) % 4 < original.size() - pos ? (seed >> 12) % 4 : original.size() - pos;
+            edits[count++] = string_edit(pos, n, texts[(seed >> 16) % 4]);
+            pos += n;
+        }
+        string expected(original);
+        expected.reserve(200);
+        for (string::size_type i = count; i-- > 0; )
+            expected.replace(edits[i].pos, edits[i].count, edits[i].text.data(), edits[i].text.size());
+
+        string shared(original);
+        string copy(shared);
+        copy.apply_edits(edits, count);
+        ASSERT_EQ(expected, copy);
+        ASSERT_EQ(original, shared);
+
+        string in_place(original.data(), original.size());
+        in_place.reserve(200);
+        const char* before = in_place.data();
+        in_place.apply_edits(edits, count);
+        ASSERT_EQ(expected, in_place);
+        ASSERT_EQ(before, in_place.data());
+    }
+
+    // Texts that are parts of the string itself
+    string s("key: value");
+    s.reserve(64);
+    const string_edit swap_edits [] = {string_edit(0, 3, string_view(s).substr(5)), string_edit(5, 5, string_view(s).substr(0, 3))};
+    s.apply_edits(swap_edits, 2);
+    ASSERT_EQ(s, "value: key");
+
+    // Replace and case conversion of a shared string leave the other owner alone
+    string a("abcdef");
+    string b(a);
+    b.replace(1, 2, "XY");
+    ASSERT_EQ(a, "abcdef");
+    ASSERT_EQ(b, "aXYdef");
+    string c(a);
+    c.to_upper();
+    ASSERT_EQ(a, "abcdef");
+    ASSERT_EQ(c, "ABCDEF");
+}
+#endif
+
+#if defined(_SSTL__STRING_INCLUDED)
+TEST(test_string, literal_length)
+{
+    // Literals keep their size, an embedded zero ends them as it does through a pointer
+    string s("key\0ignored");
+    ASSERT_EQ(3u, s.size());
+    ASSERT_TRUE(s == "key");
+    ASSERT_TRUE("key" == s);
+    ASSERT_TRUE(s == "key\0other");
+    ASSERT_TRUE(s != "keys");
+    ASSERT_TRUE(s < "kez" && "kez" > s);
+    ASSERT_EQ(0, s.compare("key"));
+    ASSERT_EQ(1u, s.find("ey"));
+
+    // Arrays are scanned up to the first zero, and not beyond the array without one
+    char buffer[16];
+    memset(buffer, 'x', sizeof(buffer));
+    memcpy(buffer, "val", 4);
+    s += buffer;
+    ASSERT_EQ("keyval", s);
+    char unterminated[4] = {'a', 'b', 'c', 'd'};
+    s.assign(unterminated);
+    ASSERT_EQ("abcd", s);
+    s.append("\0");
+    s.insert(0, "<");
+    s.replace(s.size(), 0, ">");
+    ASSERT_EQ("<abcd>", s);
+
+    // Pointers keep strlen
+    const char* p = "pointer";
+    char* q = buffer;
+    ASSERT_EQ(7u, string(p).size());
+    ASSERT_TRUE(string("val") == q);
+    ASSERT_EQ("val:pointer:key", (q + string(":") + p + ":" + "key").str());
+    ASSERT_EQ(string::intern_create("pointer").data(), string::intern_create(p).data());
+}
+#endif
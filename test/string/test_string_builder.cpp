@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <sstl/string>
+#include <sstl/string_builder>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/string_builder.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+TEST(string_builder, chunks)
+{
+    string_builder builder;
+    string expected;
+    const string line("0123456789abcdefghijklmnopqrstuvwxyz\n");
+    for (int i = 0; i < 1000; ++i)
+    {
+        builder += line;
+        builder.append(3, '-');
+        builder += 'x';
+        builder += string_view("yz", 1);
+        expected += line;
+        expected.append(3, '-');
+        expected += "xy";
+    }
+    ASSERT_EQ(expected.size(), builder.size());
+
+    const string result = builder.freeze();
+    ASSERT_EQ(expected, result);
+    ASSERT_LT(result.capacity(), result.size() + 1 + 8); // exact
+    ASSERT_EQ(result.data(), result.c_str());
+    ASSERT_TRUE(builder.empty());
+
+    // The builder can be used again
+    builder += "again";
+    ASSERT_EQ("again", builder.freeze());
+    ASSERT_TRUE(builder.freeze().empty());
+}
+
+TEST(string_builder, expected_size)
+{
+    // The first chunk becomes the string
+    string_builder builder(64);
+    builder.append(50, 'a');
+    const string header("key");
+    builder += header + ": " + "value";
+    char* p = builder.append_uninitialized(4);
+    memcpy(p, "\r\n\r\n", 4);
+    const char* first_chunk = builder.append_uninitialized(0);
+    const string result = builder.freeze();
+    ASSERT_EQ(64u, result.size());
+    ASSERT_EQ(first_chunk - 64, result.data()); // no copy
+    ASSERT_EQ(0, memcmp(result.data() + 50, "key: value\r\n\r\n", 14));
+
+    // Too little payload for the chunk, it is copied into the exact size
+    string_builder sparse(1000);
+    sparse += "short";
+    const string small = sparse.freeze();
+    ASSERT_EQ("short", small);
+    ASSERT_EQ(16u, small.capacity());
+
+    // Interned without a copy
+    string_builder interned(11);
+    interned += "builder-key";
+    const char* chunk = interned.append_uninitialized(0) - 11;
+    const string key = interned.freeze_interned();
+    ASSERT_TRUE(key.is_interned());
+    ASSERT_EQ(chunk, key.data());
+    ASSERT_EQ(key.data(), string::intern_create("builder-key").data());
+
+    string_builder cleared(32);
+    cleared.append(1000, 'z');
+    cleared.clear();
+    cleared += "kept";
+    ASSERT_EQ("kept", cleared.freeze());
+}
@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <sstl/string>
+#include <sstl/string_slice>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+TEST(string_slice, shares_large_parts)
+{
+    string message(1000, 'x');
+    message.replace(500, 4, "body");
+
+    string_slice body(message, 500);
+    EXPECT_EQ(500u, body.size());
+    EXPECT_EQ(message.data() + 500, body.data()); // no copy
+    EXPECT_TRUE(body.is_shared());
+    EXPECT_TRUE(body.view().starts_with("body"));
+
+    // Slice of the slice still shares the buffer
+    string_slice tail(body, 4);
+    EXPECT_EQ(message.data() + 504, tail.data());
+
+    // The parent changes or goes away, the slices keep the old buffer
+    message.clear();
+    message = "other";
+    EXPECT_TRUE(body.view().starts_with("body"));
+    EXPECT_EQ(496u, tail.size());
+
+    // Materializing makes a zero terminated copy once
+    const char* c = body.c_str();
+    EXPECT_EQ(500u, strlen(c));
+    EXPECT_EQ(c, body.c_str());
+    EXPECT_EQ(c, body.data());
+    EXPECT_EQ(c, body.str().data());
+}
+
+TEST(string_slice, copies_small_parts)
+{
+    string message(1000, 'x');
+    message.replace(10, 3, "abc");
+
+    string_slice small(message, 10, 3);
+    EXPECT_NE(message.data() + 10, small.data());
+    EXPECT_FALSE(small.is_shared());
+    EXPECT_TRUE(small == "abc");
+    EXPECT_EQ(string("abc"), small.str());
+
+    // The whole string is shared regardless of the size, and so is substr of it all
+    string word("word");
+    string_slice all(word);
+    EXPECT_EQ(word.data(), all.data());
+    EXPECT_EQ(word.data(), all.str().data());
+    EXPECT_EQ(word.data(), word.substr().data());
+
+    string_slice empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(0u, strlen(empty.c_str()));
+}
@@ -0,0 +1,76 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include <algorithm>
+
+#include <sstl/string>
+#include <sstl/string_sort>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/string_sort.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+static unsigned _random(unsigned& seed)
+{
+    seed = seed * 1103515245u + 12345u;
+    return seed >> 8;
+}
+
+static void _check_sorted(const string* s, int count)
+{
+    for (int i = 1; i < count; ++i)
+        ASSERT_LE(s[i - 1].compare(s[i]), 0) << i << ": " << s[i - 1].c_str() << " > " << s[i].c_str();
+}
+
+TEST(string_sort, small)
+{
+    string s [] = {"b", "", "ab", "a", "abc", "a", "ab\0"};
+    s[6] = string("ab\0", 3); // embedded zero sorts after the shorter prefix
+    sort_strings(s, s + 7);
+    ASSERT_TRUE(s[0].empty());
+    ASSERT_TRUE(s[1] == "a");
+    ASSERT_TRUE(s[2] == "a");
+    ASSERT_TRUE(s[3] == "ab");
+    ASSERT_EQ(3u, s[4].size());
+    ASSERT_TRUE(s[5] == "abc");
+    ASSERT_TRUE(s[6] == "b");
+    sort_strings(s, s); // empty range
+}
+
+TEST(string_sort, random_keys)
+{
+    // Long common prefixes, duplicates, prefixes of other keys and bytes above 127
+    static const char* const prefixes [] = {"", "http://www.example.com/", "http://www.example.com/catalog/items/", "\xF0\x9F"};
+    unsigned seed = 7;
+    const int count = 3000;
+    string* keys = new string[count];
+    string* expected = new string[count];
+    for (int i = 0; i < count; ++i)
+    {
+        string k = prefixes[_random(seed) % 4];
+        const unsigned length = _random(seed) % 20;
+        for (unsigned j = 0; j < length; ++j)
+            k += static_cast<char>(_random(seed) % 4 == 0 ? '\0' + _random(seed) % 3 : 'a' + _random(seed) % 5);
+        keys[i] = k;
+        expected[i] = k;
+    }
+    sort_strings(keys, keys + count);
+    _check_sorted(keys, count);
+
+    // The same multiset of strings
+    std::sort(expected, expected + count);
+    for (int i = 0; i < count; ++i)
+        ASSERT_TRUE(keys[i] == expected[i]) << i;
+    delete [] keys;
+    delete [] expected;
+}
+
+TEST(string_sort, pointers_and_sizes)
+{
+    const char* strings [] = {"delta", "alpha", "alphabet", "alp", "delta"};
+    sstl_size_type sizes [] = {5, 5, 8, 3, 4}; // the last one is "delt"
+    sort_strings(strings, sizes, 5);
+    const char* expected [] = {"alp", "alpha", "alphabet", "delt", "delta"};
+    for (int i = 0; i < 5; ++i)
+        ASSERT_TRUE(string(strings[i], sizes[i]) == expected[i]) << i;
+}
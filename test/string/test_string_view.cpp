@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <sstl/string>
+#include <sstl/string_view>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+TEST(string_view, basics)
+{
+    const char buffer [] = "GET /index.html HTTP/1.1\r\n";
+    const string_view line(buffer, 24);
+    EXPECT_EQ(24u, line.size());
+    EXPECT_EQ(buffer, line.data());
+    EXPECT_EQ('G', line.front());
+    EXPECT_EQ('1', line.back());
+
+    const string_view::size_type npos = string_view::npos;
+    const string_view::size_type space = line.find(' ');
+    const string_view method = line.substr(0, space);
+    const string_view target = line.substr(space + 1, line.find(' ', space + 1) - space - 1);
+    EXPECT_TRUE(method == "GET");
+    EXPECT_TRUE(target == "/index.html");
+    EXPECT_EQ(buffer + 4, target.data()); // no copy
+    EXPECT_TRUE(target.starts_with('/'));
+    EXPECT_TRUE(target.ends_with(".html"));
+    EXPECT_FALSE(target.ends_with(".htmlx"));
+    EXPECT_TRUE(line.starts_with("GET "));
+    EXPECT_EQ(npos, line.find('\r'));
+    EXPECT_EQ(16u, line.find("HTTP"));
+    EXPECT_EQ(22u, line.rfind('.'));
+    EXPECT_EQ(10u, line.find_first_of("./", 5));
+    EXPECT_EQ(23u, line.find_last_not_of(" "));
+    EXPECT_EQ(npos, line.find("HTTP/2"));
+
+    string_view v = line;
+    v.remove_prefix(4);
+    v.remove_suffix(9);
+    EXPECT_TRUE(v == target);
+    EXPECT_TRUE(v < "/z");
+    EXPECT_TRUE(v > "/index");
+    EXPECT_EQ(0, v.compare(target));
+    EXPECT_GT(0, v.compare("/index.htmlx"));
+
+    const string_view empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_TRUE(empty == "");
+    EXPECT_EQ(0u, line.find(empty));
+    EXPECT_TRUE(line.starts_with(empty));
+}
+
+TEST(string_view, string_overloads)
+{
+    const char buffer [] = "key=value;other";
+    const string_view key(buffer, 3);
+    const string_view value(buffer + 4, 5);
+
+    string s(key);
+    EXPECT_EQ("key", s);
+    s += '=';
+    s += value;
+    s.append(string_view(buffer + 9, 1));
+    EXPECT_EQ("key=value;", s);
+    s.insert(0, string_view("[", 1));
+    s.replace(s.size() - 1, 1, string_view("]"));
+    EXPECT_EQ("[key=value]", s);
+
+    s = value;
+    EXPECT_EQ("value", s);
+    s.assign(key);
+    EXPECT_EQ("key", s);
+
+    // Conversion to a view, comparisons and searches both ways
+    const string text("name: value");
+    const string_view whole = text;
+    EXPECT_EQ(text.data(), whole.data());
+    EXPECT_TRUE(text == string_view("name: value"));
+    EXPECT_TRUE(string_view("name") < text);
+    EXPECT_EQ(0, text.compare(whole));
+    EXPECT_EQ(0, text.compare_icase(string_view("NAME: VALUE")));
+    EXPECT_EQ(6u, text.find(string_view("value")));
+    EXPECT_EQ(4u, text.find_first_of(string_view(":;")));
+    EXPECT_TRUE(text.starts_with(string_view("name")));
+    EXPECT_TRUE(text.ends_with('e'));
+
+    // Assignment from a view of the same string
+    string self("abcdef");
+    self = string_view(self).substr(2);
+    EXPECT_EQ("cdef", self);
+
+    // The view of a slice probes the intern pool without a temporary string
+    const string interned = string::intern_create(value);
+    EXPECT_TRUE(interned.is_interned());
+    EXPECT_EQ(interned.data(), string::intern_create("value").data());
+    EXPECT_EQ(interned.hash(), value.hash());
+    EXPECT_EQ(string::intern_create_icase("value").data(), string::intern_create_icase(string_view("VALUE")).data());
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include <sstl/string>
+#include <sstl/utf8>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+#include <sstl/_impl/utf8.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+// Reference decoder: decode every sequence and check the code point against the rules
+static bool _reference_validate(const unsigned char* p, sstl_size_type size)
+{
+    sstl_size_type i = 0;
+    while (i < size)
+    {
+        const unsigned c = p[i];
+        unsigned length;
+        unsigned cp;
+        if (c < 0x80)
+        {
+            ++i;
+            continue;
+        }
+        else if ((c & 0xE0) == 0xC0) { length = 2; cp = c & 0x1F; }
+        else if ((c & 0xF0) == 0xE0) { length = 3; cp = c & 0x0F; }
+        else if ((c & 0xF8) == 0xF0) { length = 4; cp = c & 0x07; }
+        else
+            return false;
+        if (i + length > size)
+            return false;
+        for (unsigned k = 1; k < length; ++k)
+        {
+            if ((p[i + k] & 0xC0) != 0x80)
+                return false;
+            cp = (cp << 6) | (p[i + k] & 0x3F);
+        }
+        static const unsigned minimum [] = {0, 0, 0x80, 0x800, 0x10000};
+        if (cp < minimum[length] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+            return false;
+        i += length;
+    }
+    return true;
+}
+
+TEST(utf8, known_sequences)
+{
+    ASSERT_TRUE(utf8_validate("", 0));
+    ASSERT_TRUE(utf8_validate(string("plain ascii text that is longer than one block")));
+    ASSERT_TRUE(utf8_validate(string("\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82 \xE2\x82\xAC \xF0\x9F\x98\x80")));
+    ASSERT_TRUE(utf8_validate(string("\xED\x9F\xBF \xEE\x80\x80 \xF4\x8F\xBF\xBF"))); // around surrogates, the largest code point
+
+    static const char* const invalid [] = {
+        "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF",
+        "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80", "\xFF", "\xC3", "\xE2\x82", "\xF0\x9F\x98",
+        "\xC3\x28", "\xE2\x28\xA1", "\xF0\x28\x8C\xBC"
+    };
+    for (size_t k = 0; k < sizeof(invalid) / sizeof(invalid[0]); ++k)
+    {
+        // Alone, and in the middle and at the end of longer ASCII text
+        string s(invalid[k]);
+        ASSERT_FALSE(utf8_validate(s)) << k;
+        string padded = string(13, 'a') + s + string(40, 'b');
+        ASSERT_FALSE(utf8_validate(padded)) << k;
+        string at_end = string(32 - s.size(), 'a') + s;
+        ASSERT_FALSE(utf8_validate(at_end)) << k;
+    }
+}
+
+TEST(utf8, random_cross_check)
+{
+    // Random mixes of valid pieces and single random bytes at every alignment
+    static const char* const pieces [] = {"a", "hello ", "\xC3\xA4", "\xE2\x82\xAC", "\xF0\x9F\x98\x80", "\xED\x9F\xBF", "\xF4\x8F\xBF\xBF"};
+    unsigned seed = 5;
+    char buffer [ 200 ];
+    char copy [ 200 ];
+    for (int round = 0; round < 20000; ++round)
+    {
+        sstl_size_type size = 0;
+        while (size < 150)
+        {
+            seed = seed * 1103515245u + 12345u;
+            const unsigned r = (seed >> 8) % 64;
+            if (r == 0)
+                buffer[size++] = static_cast<char>(seed >> 24); // usually breaks the text
+            else
+            {
+                const char* piece = pieces[r % 7];
+                memcpy(buffer + size, piece, strlen(piece));
+                size += static_cast<sstl_size_type>(strlen(piece));
+            }
+        }
+        const sstl_size_type length = (seed >> 4) % size;
+        const bool expected = _reference_validate(reinterpret_cast<const unsigned char*>(buffer), length);
+        ASSERT_EQ(expected, utf8_validate(buffer, length)) << round;
+        ASSERT_EQ(expected, _utf8_copy_validate(copy, buffer, length)) << round;
+        if (expected)
+        {
+            ASSERT_EQ(0, memcmp(copy, buffer, length));
+            sstl_size_type code_points = 0;
+            for (sstl_size_type i = 0; i < length; ++i)
+                if ((buffer[i] & 0xC0) != 0x80)
+                    ++code_points;
+            ASSERT_EQ(code_points, utf8_length(buffer, length));
+        }
+    }
+}
+
+TEST(utf8, assign_utf8)
+{
+    string s("old contents");
+    string shared = s;
+    ASSERT_TRUE(s.assign_utf8("\xD0\x9F\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82", 12));
+    ASSERT_EQ(6u, utf8_length(s));
+    ASSERT_TRUE(shared == "old contents");
+    ASSERT_TRUE(s.assign_utf8("short", 5)); // in place
+    ASSERT_TRUE(s == "short");
+    ASSERT_FALSE(s.assign_utf8("bad \xC0\x80", 6));
+    ASSERT_TRUE(s.empty());
+}
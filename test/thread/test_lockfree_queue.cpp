@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include <sched.h>
+
+#include <sstl/lockfree_queue>
+#include <sstl/string>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+TEST(test_lockfree_queue, spsc_single_thread)
+{
+    spsc_queue<int> q(5);
+    ASSERT_EQ(8u, q.capacity());
+    ASSERT_TRUE(q.empty());
+    for (int i = 0; i < 8; ++i)
+        ASSERT_TRUE(q.push(i));
+    ASSERT_FALSE(q.push(8)); // full
+    ASSERT_EQ(8u, q.size());
+
+    int v = -1;
+    for (int i = 0; i < 8; ++i)
+    {
+        ASSERT_TRUE(q.pop(v));
+        ASSERT_EQ(i, v);
+    }
+    ASSERT_FALSE(q.pop(v));
+
+    int items [] = {10, 11, 12, 13, 14, 15, 16, 17, 18, 19};
+    ASSERT_EQ(8u, q.push_move(items, 10)); // wraps around
+    int out [10];
+    ASSERT_EQ(8u, q.pop(out, 10));
+    for (int i = 0; i < 8; ++i)
+        ASSERT_EQ(10 + i, out[i]);
+}
+
+TEST(test_lockfree_queue, mpmc_single_thread)
+{
+    mpmc_queue<int> q(4);
+    ASSERT_EQ(4u, q.capacity());
+    int items [] = {1, 2, 3};
+    ASSERT_EQ(3u, q.push_move(items, 3));
+    ASSERT_TRUE(q.push(4));
+    ASSERT_FALSE(q.push(5));
+    ASSERT_EQ(4u, q.size());
+
+    int out [4];
+    ASSERT_EQ(2u, q.pop(out, 2));
+    ASSERT_EQ(1, out[0]);
+    ASSERT_EQ(2, out[1]);
+    ASSERT_TRUE(q.push(5));
+    ASSERT_TRUE(q.push(6));
+    ASSERT_EQ(4u, q.pop(out, 10));
+    ASSERT_EQ(3, out[0]);
+    ASSERT_EQ(6, out[3]);
+    ASSERT_TRUE(q.empty());
+}
+
+TEST(test_lockfree_queue, string_is_moved_by_pointer)
+{
+    spsc_queue<string> q(4);
+    string s("a message long enough to have its own buffer");
+    const char* bytes = s.data();
+    ASSERT_TRUE(q.push_move(s));
+    ASSERT_TRUE(s.empty());
+
+    string r;
+    ASSERT_TRUE(q.pop(r));
+    ASSERT_EQ(bytes, r.data()); // the very same buffer
+    ASSERT_FALSE(r.is_shared());  // and its reference counter was not touched
+    ASSERT_EQ(r, "a message long enough to have its own buffer");
+
+    mpmc_queue<string> m(4);
+    ASSERT_TRUE(m.push(r)); // copy shares the buffer
+    ASSERT_TRUE(r.is_shared());
+    string r2;
+    ASSERT_TRUE(m.pop(r2));
+    ASSERT_EQ(bytes, r2.data());
+
+    ASSERT_TRUE(m.push(r2)); // leave something for the destructor
+    ASSERT_TRUE(q.push(r2));
+}
+
+#if !defined(_WIN32)
+
+static const int items_per_producer = 100000;
+static const int producer_count = 3;
+
+struct _mpmc_context
+{
+    mpmc_queue<string>* queue;
+    int id;
+    long long sum;
+};
+
+static void* _produce(void* p)
+{
+    _mpmc_context* c = static_cast<_mpmc_context*>(p);
+    char buff [32];
+    for (int i = 0; i < items_per_producer; )
+    {
+        string batch [4];
+        int n = 0;
+        for ( ; n < 4 && i + n < items_per_producer; ++n)
+        {
+            sprintf(buff, "%d", c->id * items_per_producer + i + n);
+            batch[n] = buff;
+        }
+        int pushed = 0;
+        while (pushed < n)
+        {
+            pushed += c->queue->push_move(batch + pushed, n - pushed);
+            if (pushed < n)
+                sched_yield();
+        }
+        i += n;
+    }
+    return NULL;
+}
+
+static void* _consume(void* p)
+{
+    _mpmc_context* c = static_cast<_mpmc_context*>(p);
+    string s;
+    for (int received = 0; received < items_per_producer; )
+    {
+        if (c->queue->pop(s))
+        {
+            c->sum += atoi(s.c_str());
+            ++received;
+        }
+        else
+            sched_yield();
+    }
+    return NULL;
+}
+
+TEST(test_lockfree_queue, mpmc_threads)
+{
+    mpmc_queue<string> q(64);
+    _mpmc_context producers [producer_count];
+    _mpmc_context consumers [producer_count];
+    pthread_t threads [producer_count * 2];
+    for (int i = 0; i < producer_count; ++i)
+    {
+        producers[i].queue = consumers[i].queue = &q;
+        producers[i].id = consumers[i].id = i;
+        producers[i].sum = consumers[i].sum = 0;
+        ASSERT_EQ(0, pthread_create(&threads[i * 2], NULL, _produce, &producers[i]));
+        ASSERT_EQ(0, pthread_create(&threads[i * 2 + 1], NULL, _consume, &consumers[i]));
+    }
+    long long sum = 0;
+    for (int i = 0; i < producer_count * 2; ++i)
+        pthread_join(threads[i], NULL);
+    for (int i = 0; i < producer_count; ++i)
+        sum += consumers[i].sum;
+
+    const long long n = static_cast<long long>(producer_count) * items_per_producer;
+    ASSERT_EQ(n * (n - 1) / 2, sum);
+    ASSERT_TRUE(q.empty());
+}
+
+#endif
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <string.h>
+
+#define SSTL_CONFIG_LOCK_PROFILING 1
+
+#include <sstl/mutex>
+#include <sstl/algorithm> // after mutex, system headers included by mutex stay out of the namespace
+#include <sstl/string>
+#include <sstl/_impl/string.cpp>
+#include <sstl/_impl/string_view.cpp>
+
+using namespace SSTL_NAMESPACE;
+
+struct _found_statistics
+{
+    const char* name;
+    bool found;
+    mutex_statistics statistics;
+};
+
+static void _find_by_name(const char* name, const mutex_statistics& statistics, void* context)
+{
+    _found_statistics* f = static_cast<_found_statistics*>(context);
+    if (strcmp(f->name, name) == 0)
+    {
+        f->found = true;
+        f->statistics = statistics;
+    }
+}
+
+TEST(test_mutex, profiled_uncontended)
+{
+    profiled_mutex m("test uncontended");
+    for (int i = 0; i < 10; ++i)
+    {
+        lock_guard<profiled_mutex> lock(m);
+    }
+    ASSERT_TRUE(m.try_lock());
+    m.unlock();
+
+    mutex_statistics s = m.statistics();
+    ASSERT_EQ(11u, s.acquisitions);
+    ASSERT_EQ(0u, s.contended_acquisitions);
+    ASSERT_EQ(0u, s.total_wait);
+    ASSERT_LE(s.max_hold, s.total_hold);
+
+    m.reset_statistics();
+    ASSERT_EQ(0u, m.statistics().acquisitions);
+}
+
+#if !defined(_WIN32)
+
+static void* _hold_for_a_while(void* p)
+{
+    profiled_mutex* m = static_cast<profiled_mutex*>(p);
+    m->lock();
+    usleep(20000);
+    m->unlock();
+    return NULL;
+}
+
+TEST(test_mutex, profiled_contended)
+{
+    profiled_mutex m("test contended");
+    m.lock();
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, _hold_for_a_while, &m));
+    usleep(20000); // let the thread block in lock()
+    m.unlock();
+    pthread_join(thread, NULL);
+
+    ASSERT_TRUE(m.try_lock()); // nobody holds it now
+    m.unlock();
+
+    mutex_statistics s = m.statistics();
+    ASSERT_EQ(3u, s.acquisitions);
+    ASSERT_EQ(1u, s.contended_acquisitions);
+    ASSERT_LT(0u, s.total_wait);
+    ASSERT_EQ(s.max_wait, s.total_wait);
+    ASSERT_LE(20000000u, s.max_hold); // the thread held it for 20 milliseconds
+}
+
+static void* _dump_from_other_thread(void*)
+{
+    mutex_profile_registry::dump(stdout);
+    return NULL;
+}
+
+TEST(test_mutex, registry_while_locked)
+{
+    // The registry reads the statistics of a mutex held by this or another thread
+    profiled_mutex m("test registry while locked");
+    m.lock();
+    mutex_profile_registry::dump(stdout);
+    mutex_profile_registry::reset();
+    pthread_t thread;
+    ASSERT_EQ(0, pthread_create(&thread, NULL, _dump_from_other_thread, NULL));
+    pthread_join(thread, NULL);
+    {
+        profiled_mutex inner("test registry nested"); // registers while m is held
+    }
+    ASSERT_EQ(0u, m.statistics().acquisitions);
+    m.unlock();
+    ASSERT_EQ(0u, m.statistics().acquisitions);
+    ASSERT_LT(0u, m.statistics().total_hold);
+}
+
+#endif
+
+TEST(test_mutex, registry)
+{
+    string s = string::intern_create("registry");
+    ASSERT_TRUE(s.is_interned());
+
+    {
+        profiled_mutex m("test registry");
+        m.lock();
+        m.unlock();
+
+        _found_statistics f = {"test registry", false, mutex_statistics()};
+        mutex_profile_registry::for_each(_find_by_name, &f);
+        ASSERT_TRUE(f.found);
+        ASSERT_EQ(1u, f.statistics.acquisitions);
+    }
+
+    _found_statistics f = {"test registry", false, mutex_statistics()};
+    mutex_profile_registry::for_each(_find_by_name, &f);
+    ASSERT_FALSE(f.found); // unregistered in destructor
+
+    _found_statistics intern = {"sstl::string intern pool", false, mutex_statistics()};
+    mutex_profile_registry::for_each(_find_by_name, &intern);
+    ASSERT_TRUE(intern.found);
+    ASSERT_LE(1u, intern.statistics.acquisitions);
+
+    mutex_profile_registry::dump(stdout);
+    mutex_profile_registry::reset();
+    mutex_profile_registry::for_each(_find_by_name, &intern);
+    ASSERT_EQ(0u, intern.statistics.acquisitions);
+}